@@ -0,0 +1,109 @@
+#include<assert.h>
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Autobaud (CTRL bit 3).
+//
+// The uart comes out of reset with its default multiplier, which is
+// nothing like the rate of the peer. Autobaud is armed, and the peer
+// sends its 'U' on rxd_i at some bit time, followed by nothing until
+// autobaud is done. Then CM0-CM3 have to read back the multiplier for
+// that rate, rounded to the nearest, 2^36 / bit clocks at 16x (2^35 at
+// 8x), the 'U' must not have been received, and the characters the
+// peer sends next, at the same rate, have to arrive intact.
+//
+// The baud generator ticks every other clock at most, so the shortest
+// bit time is 32 clocks at 16x and 16 at 8x. hw-cbmc takes either
+// oversampling mode and an arbitrary bit time from there to MAX_BIT
+// clocks. The native run goes through all of them.
+// ---------------------------------------------------------------------
+
+#define MIN_BIT16 32
+#define MIN_BIT8 16
+#define MAX_BIT 40
+#define BITS16 (MAX_BIT - MIN_BIT16 + 1)
+#define BITS8 (MAX_BIT - MIN_BIT8 + 1)
+#define CHARS 2
+
+#ifdef NATIVE_SIM
+#include <stdlib.h>
+#define nondet_u8() ((u8)rand())
+#define RUNS (BITS16 + BITS8)
+#else
+u8 nondet_u8(void);
+#define RUNS 1
+#endif
+
+// One 8N1 frame on rxd_i, bit clocks a bit
+static void send(u8 c, int bit) {
+  int i;
+
+  rtfSimpleUart.rxd_i = 0;                        // start
+  wb_idle_n(bit);
+  for (i=0; i<8; i++) {
+    rtfSimpleUart.rxd_i = (c >> i) & 1;
+    wb_idle_n(bit);
+  }
+  rtfSimpleUart.rxd_i = 1;                        // stop
+  wb_idle_n(bit);
+}
+
+static void check_rate(int bit, int x8) {
+  unsigned long long num = 1ULL << (36 - x8);
+  _u32 expect = (num + bit / 2) / bit;
+  _u32 m;
+  u8 txmsg[CHARS];
+  u8 b;
+  int i;
+
+  outb(0x08 | x8 << 1, UART_CR);   // arm, no hardware flow control
+  GOAL(inb(UART_CR) & 0x08);
+  send(0x55, bit);
+
+  b = wb_wait_until(UART_CR, 0x08, 0x00, 2 * bit);
+  GOAL(!(b & 0x08));                              // done
+  m = inb(UART_CM0);
+  m |= (_u32)inb(UART_CM1) << 8;
+  m |= (_u32)inb(UART_CM2) << 16;
+  m |= (_u32)inb(UART_CM3) << 24;
+  GOAL(m == expect);
+  GOAL(!(inb(UART_LS) & 0x01));                   // the 'U' isn't data
+
+  for (i=0; i<CHARS; i++) {
+    txmsg[i] = nondet_u8();
+    send(txmsg[i], bit);
+  }
+  b = wb_wait_until(UART_LS, 0x01, 0x01, bit);
+  GOAL(b & 0x01);
+  GOAL(!(b & 0x0e));        // no framing or parity error, or overrun
+  for (i=0; i<CHARS; i++)
+    GOAL(inb(UART_TR) == txmsg[i]);
+}
+
+int main(void) {
+
+  int i;
+
+  rtfSimpleUart.rxd_i = 1;
+  rtfSimpleUart.cts_ni = 0;
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+  outb(0x00, UART_IE);      // no:  interrupts, we poll
+
+  for (i=0; i<RUNS; i++) {
+    int bit, x8;
+    if (RUNS > 1) {
+      x8 = i >= BITS16;
+      bit = x8 ? MIN_BIT8 + i - BITS16 : MIN_BIT16 + i;
+    } else {
+      x8 = nondet_u8() & 1;
+      bit = x8 ? MIN_BIT8 + nondet_u8() % BITS8 : MIN_BIT16 + nondet_u8() % BITS16;
+    }
+    check_rate(bit, x8);
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include<assert.h>
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Achieved baud rate error across the rate table, on a CLK_HZ clock.
+//
+// For each rate the full 32 bit clock multiplier is computed and
+// written to CM0-CM3, a 0x55 is sent, and the clocks from the falling
+// edge of the start bit to the falling edge of data bit 7 (eight bit
+// times) are counted on txd_o. The rate that gives has to be as close
+// to the nominal one as the multiplier allows: its rounding, plus the
+// low bits a narrower accumulator ignores (BAUD_WIDTH, which has to
+// match the pBaudWidth of the rtl), plus one clock of measurement,
+// since every tick is at most one clock off.
+//
+// The slow rates take some 100k clocks, so this is for the native
+// simulation (make baud_error_native), not for hw-cbmc.
+// ---------------------------------------------------------------------
+
+#ifndef CLK_HZ
+#define CLK_HZ 100000000ULL
+#endif
+#ifndef BAUD_WIDTH
+#define BAUD_WIDTH 32
+#endif
+
+static const unsigned long rates[] = {
+  9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600,
+  1843200, 3000000,
+};
+
+// Clocks until txd_o falls, from last, the level it had before
+static unsigned long next_fall(_u8 last, unsigned long max_cycles) {
+  unsigned long n = 0;
+  while (n < max_cycles && !(last && !rtfSimpleUart.txd_o)) {
+    last = rtfSimpleUart.txd_o;
+    wb_idle();
+    n++;
+  }
+  return n;
+}
+
+int main(void) {
+
+  unsigned i;
+  int j;
+
+  rtfSimpleUart.cts_ni = 0;
+  rtfSimpleUart.rxd_i = 1;
+
+  wb_reset();
+  wb_idle();
+  outb(0x00, UART_CR);      // no:  hardware flow control
+
+  for (i=0; i<sizeof rates / sizeof rates[0]; i++) {
+    unsigned long long ideal = ((16ULL * rates[i] << 32) + CLK_HZ / 2) / CLK_HZ;
+    _u32 m = ideal;
+    _u32 used = m & ~0ULL << (32 - BAUD_WIDTH);
+    unsigned long bit = CLK_HZ / rates[i] + 1;
+    unsigned long n;
+    double nominal, err, limit, exact;
+
+    outb(m, UART_CM0);
+    outb(m >> 8, UART_CM1);
+    outb(m >> 16, UART_CM2);
+    outb(m >> 24, UART_CM3);
+
+    outb(0x55, UART_TR);
+    next_fall(1, 4 * bit);    // the start bit, the line was idle
+    n = 0;
+    for (j=0; j<4; j++)       // data bits 1, 3, 5 and 7
+      n += next_fall(rtfSimpleUart.txd_o, 3 * bit);
+
+    // The error the multiplier can't avoid, and the measured one
+    exact = 16.0 * rates[i] * 4294967296.0 / CLK_HZ;
+    nominal = 8.0 * CLK_HZ / rates[i];
+    err = (nominal - n) / n;
+    limit = (exact > used ? exact - used : used - exact) / exact + 1.0 / n;
+#ifdef NATIVE_SIM
+    fprintf(stderr, "%8lu baud  multiplier %08x  %7lu clocks per 8 bits  error %+9.2f ppm  (limit %.2f)\n",
+            rates[i], used, n, err * 1e6, limit * 1e6);
+#endif
+    GOAL((err < 0 ? -err : err) <= limit);
+
+    wb_wait_until(UART_LS, 0x40, 0x40, 4 * bit);
+  }
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include<assert.h>
+#include "rtfSimpleUartBaud.h"
+
+// ---------------------------------------------------------------------
+// Refinement check for the abstract baud ticks (WB_ABSTRACT_BAUD in
+// wishbone.h): with a clock multiplier between 2^32/WB_BAUD_GAP and
+// 2^31 the accumulator gives at least one tick in every WB_BAUD_GAP
+// clocks. Each step adds at least 1/WB_BAUD_GAP and at most half of
+// the accumulator range, so the msb has to rise somewhere in the
+// window.
+//
+// There is no reset. hw-cbmc starts the accumulator and the edge
+// detector in an arbitrary state, so checking one window checks every
+// window the real design can get to. The first clock is only used to
+// load the edge detector with the msb.
+// ---------------------------------------------------------------------
+
+#ifndef WB_BAUD_GAP
+#define WB_BAUD_GAP 4
+#endif
+
+#define MIN_CK_MUL ((0x100000000ULL + WB_BAUD_GAP - 1) / WB_BAUD_GAP)
+
+_u32 nondet_u32(void);
+
+int main(void) {
+
+  int i;
+  int ticks = 0;
+  _u32 m = nondet_u32();
+
+  __CPROVER_assume(m >= MIN_CK_MUL && m <= 0x80000000u);
+
+  rtfSimpleUartBaud.rst_i = 0;
+  rtfSimpleUartBaud.tick_i = 0;
+  rtfSimpleUartBaud.ck_mul = m;
+
+  set_inputs();
+  next_timeframe();
+
+  for (i=0; i<WB_BAUD_GAP; i++) {
+    set_inputs();
+    if (rtfSimpleUartBaud.baud16)
+      ticks++;
+    next_timeframe();
+  }
+
+  assert(ticks >= 1);
+
+  return 0;
+}
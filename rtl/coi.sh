@@ -0,0 +1,121 @@
+#!/bin/sh
+# ---------------------------------------------------------------------
+# Cone of influence: prunes the rtl down to the logic a harness can
+# observe, and reports the state bits before and after.
+#
+# What a harness observes and drives is read off the harness and
+# wishbone.h: the outputs it looks at (rtfSimpleUart.irq_o, ...), and
+# the inputs it assigns. Clocks are always kept. A wrapper with the
+# same name and ports as the top then leaves the other outputs
+# unconnected (tied to 0) and ties the inputs the harness never
+# assigns to 0, which is what the harness gives them anyway. yosys
+# flattens it, folds the constants and strips whatever no longer
+# reaches an output, eg. the synchronizers of the modem inputs
+# (dsr_ni, dcd_ni) a harness never drives.
+#
+# That is all the pruning there is. There is no reachability step, so
+# state behind an enable held in a register stays even when the
+# harness never sets it: the 8x, majority sampling, autobaud and
+# automatic rts paths, txc, and the dma engine of a top with pDma = 1
+# are loaded from dat_i, which every harness drives, and are kept.
+# For most harnesses the pruned netlist is close to the full one; the
+# report shows by how much.
+#
+# The pruned netlist, coi/<harness>/<top>.v, has the same ports as
+# the top, so hw-cbmc runs the harness on it with the usual interface
+# header (make <harness>_coi).
+#
+#   ./coi.sh [-t top] harness verilog_file...
+#
+# State bits are flip-flop bits after mapping the fifo memories to
+# flip-flops.
+# ---------------------------------------------------------------------
+
+cd "$(dirname "$0")" || exit 2
+
+YOSYS=${YOSYS:-yosys}
+COI=coi
+top=rtfSimpleUart
+
+usage() {
+  echo "usage: $0 [-t top] harness verilog_file..." >&2
+  exit 2
+}
+
+while getopts t: opt; do
+  case $opt in
+  t) top=$OPTARG ;;
+  *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ $# -ge 2 ] || usage
+h=$1
+shift
+
+dir=$COI/$h
+mkdir -p "$dir"
+
+# Ports of the top, "<input|output> <range> <name>" per line
+sed -n "/^module $top\\b/,/);/p" "$top.v" |
+  sed -n 's/^[[:space:]]*\(input\|output\)\([[:space:]]\+reg\)\?[[:space:]]*\(\[[^]]*\]\)\?[[:space:]]*\([a-z0-9_]*\).*/\1 \3 \4/p' |
+  sed 's/^\(input\|output\)  /\1 - /' > "$dir/ports"
+[ -s "$dir/ports" ] || { echo "$0: no ports found for $top" >&2; exit 2; }
+
+# Ports the harness touches
+used=" clk_i $(cat "$h.c" wishbone.h | grep -o 'rtfSimpleUart\.[a-z0-9_]*' | sed 's/.*\.//' | sort -u | tr '\n' ' ')"
+
+# The wrapper
+{
+  echo "module $top("
+  awk '{ printf "%s\t%s %s %s", sep, $1, ($2 == "-" ? "" : $2), $3; sep = ",\n" } END { print "" }' "$dir/ports"
+  echo ");"
+  echo "${top}_full u ("
+  sep=
+  while read -r dirn range p; do
+    case "$used" in
+    *" $p "*) conn=$p ;;
+    *) [ $dirn = input ] && conn="0" || conn= ;;
+    esac
+    printf '%s\t.%s(%s)' "$sep" "$p" "$conn"
+    sep=",
+"
+  done < "$dir/ports"
+  echo
+  echo ");"
+  while read -r dirn range p; do
+    case "$used" in
+    *" $p "*) ;;
+    *) [ $dirn = output ] && echo "assign $p = 0;" ;;
+    esac
+  done < "$dir/ports"
+  echo "endmodule"
+} > "$dir/wrapper.v"
+
+cat > "$dir/coi.ys" <<EOF
+read_verilog $*
+hierarchy -top $top
+proc; flatten; memory -nomap; opt_clean
+design -save full
+memory_map; techmap; opt -fast
+tee -q -o $dir/before select -count t:\$_*DFF*
+design -load full
+rename $top ${top}_full
+read_verilog $dir/wrapper.v
+hierarchy -top $top
+flatten
+opt -full -sat; opt_clean -purge
+write_verilog -noattr $dir/$top.v
+memory_map; techmap; opt -fast
+tee -q -o $dir/after select -count t:\$_*DFF*
+EOF
+
+$YOSYS -q -l "$dir/log" "$dir/coi.ys" > /dev/null || {
+  echo "$0: yosys failed, see $dir/log" >&2
+  exit 2
+}
+
+before=$(grep -o '[0-9]* objects' "$dir/before" | cut -d' ' -f1)
+after=$(grep -o '[0-9]* objects' "$dir/after" | cut -d' ' -f1)
+unused=$(grep -v "^[a-z]* [^ ]* \\($(echo $used | sed 's/ /\\|/g')\\)\$" "$dir/ports" | cut -d' ' -f3 | tr '\n' ' ')
+printf '%-20s %-26s state bits %5s -> %5s  cut: %s\n' "$h" "$top" "$before" "$after" "$unused"
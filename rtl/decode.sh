@@ -0,0 +1,215 @@
+#!/bin/sh
+# ---------------------------------------------------------------------
+# Trace decoder: turns a waveform into a log of what happened, one
+# line per event with the clock it happened at:
+#
+#   - Wishbone transactions on the slave port, with the register
+#     names of the UART_* map in wishbone.h (a block transfer gives
+#     one line per beat)
+#   - frames on the serial lines (txd_o, rxd_i, and txd_int /
+#     rxd_int for loopback), with framing and parity errors, in the
+#     frame format of the FF register: 8N1 from reset (or -f), then
+#     whatever the trace writes to FF
+#   - irq_o going up and down
+#
+# It reads the trace once, as a stream, so long counterexamples take
+# seconds. FST traces go through gtkwave's fst2vcd.
+#
+#   ./decode.sh [-p] [-b clocks_per_bit] [-s timesteps_per_clock] [-f ff] trace
+#
+# -p is for the pipelined top, where a transfer is acknowledged on the
+# clock after its request.
+# The serial bit time is 16 baud ticks; with CM3 = 0x80 (a tick every
+# other clock) that's the default of 32 clocks. hw-cbmc traces have
+# one timestep per clock, native ones (sim/native.cpp) have two.
+# -f gives the FF value to start with, for a trace that begins after
+# the harness set the format.
+#
+# Each name is taken from the topmost scope that has it, so the
+# ports of the top win over the same names in the submodules.
+# ---------------------------------------------------------------------
+
+BIT=32
+STEP=
+PIPELINED=0
+FF=3
+
+usage() {
+  echo "usage: $0 [-p] [-b clocks_per_bit] [-s timesteps_per_clock] [-f ff] trace" >&2
+  exit 2
+}
+
+while getopts pb:s:f: opt; do
+  case $opt in
+  p) PIPELINED=1 ;;
+  b) BIT=$OPTARG ;;
+  s) STEP=$OPTARG ;;
+  f) FF=$((OPTARG)) ;;
+  *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 1 ] || usage
+
+case $1 in
+*.fst)
+  [ -n "$STEP" ] || STEP=2
+  cat="fst2vcd $1" ;;
+*)
+  [ -n "$STEP" ] || STEP=1
+  cat="cat $1" ;;
+esac
+
+$cat | awk -v bit="$BIT" -v step="$STEP" -v pipelined="$PIPELINED" -v ff="$FF" '
+BEGIN {
+  split("TR LS MS IS IE FF MC CR CM0 CM1 CM2 CM3 FC 13 RTSW SPR " \
+        "DMA_AD0 DMA_AD1 DMA_AD2 DMA_AD3 DMA_LN0 DMA_LN1 DMA_CTL DMA_ST", names, " ")
+  nlines = split("txd_o rxd_i txd_int rxd_int", lines, " ")
+  for (i = 1; i <= nlines; i++)
+    isline[lines[i]] = 1
+  split("rst_i cyc_i stb_i we_i adr_i dat_i dat_o ack_o irq_o", sigs, " ")
+  for (i in sigs)
+    want[sigs[i]] = 1
+  t = -1
+  depth = 0
+}
+
+function value(v,   n, i, c) {
+  if (v !~ /^[01]+$/)
+    return -1           # x or z
+  n = 0
+  for (i = 1; i <= length(v); i++)
+    n = n * 2 + (substr(v, i, 1) == "1")
+  return n
+}
+
+function reg(a,   off) {
+  off = a - 4292610560          # UART_TR, 0xffdc0a00
+  if (off >= 0 && off < 24)
+    return names[off + 1]
+  return sprintf("0x%08x", a)
+}
+
+# One clock with the current values
+function clock(c,   i, s, b, req) {
+  # The request an acknowledge belongs to: the one on this clock, or in
+  # pipelined mode the one before
+  req = val["cyc_i"] == 1 && val["stb_i"] == 1 && val["rst_i"] != 1
+  if (!pipelined) {
+    req_ok = req
+    req_we = val["we_i"]
+    req_adr = val["adr_i"]
+    req_dat = val["dat_i"]
+  }
+  if (req_ok && val["cyc_i"] == 1 && val["ack_o"] == 1) {
+    if (req_we == 1) {
+      printf "%8d  write %-8s 0x%02x\n", c, reg(req_adr), req_dat
+      if (reg(req_adr) == "FF")
+        ff = req_dat % 32
+    } else
+      printf "%8d  read  %-8s 0x%02x\n", c, reg(req_adr), val["dat_o"]
+  }
+  if (pipelined) {
+    req_ok = req
+    req_we = val["we_i"]
+    req_adr = val["adr_i"]
+    req_dat = val["dat_i"]
+  }
+  if ("irq_o" in val && !(c > 0 && val["irq_o"] == irq)) {
+    if (c > 0)
+      printf "%8d  irq_o %d\n", c, val["irq_o"]
+    irq = val["irq_o"]
+  }
+  for (i = 1; i <= nlines; i++) {
+    s = lines[i]
+    if (!(s in val))
+      continue
+    if (!(s in phase)) {
+      # idle, wait for a start bit
+      if (val[s] == 0)
+        phase[s] = 0
+      continue
+    }
+    phase[s]++
+    # sample in the middle of each bit: start, data, parity, stop
+    if (phase[s] % bit != int(bit / 2))
+      continue
+    b = int(phase[s] / bit)
+    if (b == 0) {
+      if (val[s] != 0) {
+        delete phase[s]         # glitch, not a start bit
+      } else {
+        # the format is taken at the start bit, as the receiver does
+        data[s] = 0
+        ones[s] = 0
+        nd[s] = 5 + ff % 4
+        pen[s] = int(ff / 8) % 2
+        even[s] = int(ff / 16) % 2
+      }
+    } else if (b <= nd[s]) {
+      data[s] += (val[s] == 1) * 2 ^ (b - 1)
+      ones[s] += (val[s] == 1)
+    } else if (pen[s] && b == nd[s] + 1) {
+      ones[s] += (val[s] == 1)
+    } else {
+      printf "%8d  %-8s frame 0x%02x", c, s, data[s]
+      if (data[s] >= 32 && data[s] < 127)
+        printf " %c", data[s]
+      if (pen[s] && ones[s] % 2 != (even[s] ? 0 : 1))
+        printf ", parity error"
+      if (val[s] != 1)
+        printf ", framing error"
+      printf "\n"
+      delete phase[s]
+    }
+  }
+}
+
+# Definitions: for each name we decode, the variable in the topmost
+# scope, counting both $scope nesting and dotted names
+$1 == "$scope" { depth++; next }
+$1 == "$upscope" { depth--; next }
+$1 == "$var" {
+  ref = $5
+  d = depth + gsub(/[.\\]/, ".", ref)
+  sub(/.*\./, "", ref)
+  if ((ref in want || ref in isline) && (!(ref in id) || d < vdepth[ref])) {
+    if (ref in id)
+      delete name[id[ref]]
+    id[ref] = $4
+    vdepth[ref] = d
+    name[$4] = ref
+  }
+  next
+}
+
+/^\$/ { next }
+
+# Time moves on: run the clocks that start before the new time with
+# the values as they were
+/^#/ {
+  now = substr($1, 2) + 0
+  if (t >= 0)
+    for (c = int((t + step - 1) / step); c * step < now; c++)
+      clock(c)
+  t = now
+  next
+}
+
+/^[bB]/ {
+  if ($2 in name)
+    val[name[$2]] = value(substr($1, 2))
+  next
+}
+
+/^[01xXzZ]/ {
+  code = substr($1, 2)
+  if (code in name)
+    val[name[code]] = value(substr($1, 1, 1))
+}
+
+END {
+  if (t >= 0 && t % step == 0)
+    clock(t / step)
+}
+'
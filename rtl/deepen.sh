@@ -0,0 +1,151 @@
+#!/bin/sh
+# ---------------------------------------------------------------------
+# Iterative deepening: finds, for every GOAL() of a harness (see
+# wishbone.h), the smallest bound at which it is settled, instead of
+# paying for a guessed --bound. Each goal is tried at doubling bounds
+# from the start bound up to the max bound, and stops at the first
+# conclusive one:
+#
+#   FAIL   there is a counterexample within the bound
+#   HOLDS  the goal is reached within the bound and holds on every
+#          path that reaches it there
+#   OPEN   the goal isn't reached within the bound, go deeper
+#
+# A goal that passes is run once more with -DGOAL_REACH to tell HOLDS
+# from OPEN. The last doubling step is then bisected down to the
+# smallest conclusive bound, to within the granularity.
+#
+# There is no solver state reuse: hw-cbmc can't keep the solver
+# between bounds, so every run unrolls and solves from scratch. The
+# cost is that of the conclusive bound b times the number of runs at
+# or near it, not once: a passing try is solved twice (with and
+# without GOAL_REACH), and the bisection adds about
+# log2(b / (2 * granularity)) tries between b/2 and b, each close to
+# the cost of b. Only the doubling tries below b/2 come cheap. What it
+# saves is the guessing: no goal is solved at a bound much past the
+# one it needs. The runs column of the report counts the solver runs.
+#
+#   ./deepen.sh [-s start] [-m max] [-g granularity] harness [goal...]
+#
+# Without goals it goes through 1, 2, ... until one isn't reached
+# within the max bound, or gives an error. Logs go to deepen/<harness>/<goal>/<bound>/.
+# The exit status is non-zero if any goal failed.
+# ---------------------------------------------------------------------
+
+self=$(cd "$(dirname "$0")" && pwd)/$(basename "$0")
+cd "$(dirname "$self")" || exit 2
+
+DEEPEN=deepen
+START=100
+MAX=4000
+GRAIN=10
+
+usage() {
+  echo "usage: $0 [-s start] [-m max] [-g granularity] harness [goal...]" >&2
+  exit 2
+}
+
+# One hw-cbmc run of goal $2 of harness $1 at bound $3, the result
+# (PASS, FAIL or ERROR) on stdout. $4 tags the run directory, the
+# rest are make variables.
+run() {
+  h=$1; n=$2; b=$3; dir=$DEEPEN/$1/$2/$3$4
+  shift 4
+  rm -rf "$dir"
+  mkdir -p "$dir"
+  make -s "${h}_goal" GOAL_ONLY="$n" GOAL_BOUND="$b" OUT="$dir" "$@" > "$dir/log" 2>&1
+  rc=$?
+  if [ $rc -eq 0 ]; then
+    echo PASS
+  elif grep -q "VERIFICATION FAILED" "$dir/log"; then
+    echo FAIL
+  else
+    echo ERROR
+  fi
+}
+
+# Goal $2 of harness $1 at bound $3: FAIL, HOLDS, OPEN or ERROR
+probe() {
+  r=$(run "$1" "$2" "$3" "")
+  if [ "$r" = PASS ]; then
+    case $(run "$1" "$2" "$3" r GOAL_FLAGS=-DGOAL_REACH) in
+    FAIL) r=HOLDS ;;
+    PASS) r=OPEN ;;
+    *) r=ERROR ;;
+    esac
+  fi
+  echo "$r"
+}
+
+# Deepen goal $2 of harness $1, prints a line for it and leaves the
+# result in $result
+deepen() {
+  t0=$(date +%s)
+  rm -rf "$DEEPEN/$1/$2"
+  lo=0
+  b=$START
+  while :; do
+    result=$(probe "$1" "$2" $b)
+    [ "$result" = OPEN ] || break
+    lo=$b
+    [ $b -lt $MAX ] || break
+    b=$((b * 2))
+    [ $b -le $MAX ] || b=$MAX
+  done
+
+  # Bisect between the last open bound and the conclusive one
+  if [ "$result" = FAIL ] || [ "$result" = HOLDS ]; then
+    while [ $((b - lo)) -gt $GRAIN ]; do
+      mid=$(((lo + b) / 2))
+      r=$(probe "$1" "$2" $mid)
+      if [ "$r" = OPEN ]; then
+        lo=$mid
+      elif [ "$r" = ERROR ]; then
+        break
+      else
+        b=$mid
+        result=$r
+      fi
+    done
+  fi
+
+  runs=$(ls "$DEEPEN/$1/$2" | wc -l)
+  printf '%-20s goal %-4s %-6s bound %-6s %3s runs %6ss\n' "$1" "$2" $result $b $runs \
+    $(( $(date +%s) - t0 ))
+}
+
+while getopts s:m:g: opt; do
+  case $opt in
+  s) START=$OPTARG ;;
+  m) MAX=$OPTARG ;;
+  g) GRAIN=$OPTARG ;;
+  *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ $# -ge 1 ] || usage
+h=$1
+shift
+
+# Interface headers first
+make -s rtfSimpleUart.h rtfSimpleUartWithDma.h rtfSimpleUartAbstractBaud.h || exit 2
+
+status=0
+if [ $# -gt 0 ]; then
+  for n in "$@"; do
+    deepen "$h" "$n"
+    [ "$result" = HOLDS ] || status=1
+  done
+else
+  n=1
+  while :; do
+    deepen "$h" $n
+    [ "$result" = OPEN ] && break   # no more goals within the max bound
+    # a build or tool error would be the same for every goal after it
+    [ "$result" = ERROR ] && { status=1; break; }
+    [ "$result" = HOLDS ] || status=1
+    n=$((n + 1))
+  done
+fi
+
+exit $status
@@ -0,0 +1,103 @@
+#include<assert.h>
+#define WB_DMA
+#define WB_CLOCK_HOOK mem_cycle
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Memory model for the dma master port
+//
+// A small byte-wide memory with zero wait states: a request is
+// acknowledged on the clock it is presented. mem_cycle() is the
+// WB_CLOCK_HOOK, so it runs on every clock before set_inputs().
+// ---------------------------------------------------------------------
+
+#define MEM_SIZE 64
+
+_u8 mem[MEM_SIZE];
+
+void mem_cycle(void) {
+  rtfSimpleUart.m_ack_i = rtfSimpleUart.m_cyc_o && rtfSimpleUart.m_stb_o;
+  if (rtfSimpleUart.m_ack_i) {
+    if (rtfSimpleUart.m_we_o)
+      mem[rtfSimpleUart.m_adr_o % MEM_SIZE] = rtfSimpleUart.m_dat_o;
+    else
+      rtfSimpleUart.m_dat_i = mem[rtfSimpleUart.m_adr_o % MEM_SIZE];
+  }
+}
+
+void dma_start(_u32 addr, int len, _u8 ctl) {
+  outb (addr & 0xff, UART_DMA_AD0);
+  outb ((addr >> 8) & 0xff, UART_DMA_AD1);
+  outb ((addr >> 16) & 0xff, UART_DMA_AD2);
+  outb ((addr >> 24) & 0xff, UART_DMA_AD3);
+  outb (len & 0xff, UART_DMA_LN0);
+  outb ((len >> 8) & 0xff, UART_DMA_LN1);
+  outb (ctl | 0x80, UART_DMA_CTL);
+}
+
+// ---------------------------------------------------------------------
+// Main test routine
+// ---------------------------------------------------------------------
+
+int main(void) {
+
+  _u8 b;
+  int k;
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+
+  // Configure the uart
+
+  static const struct uart_reg config[] = {
+    { UART_MC, 0x13 },      // Loopback mode
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_CR, 0x00 },      // no:  hardware flow control
+    { UART_IE, 0x00 },      // no:  uart interrupts, only the dma one
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+
+  unsigned char txmsg[12] = "Hello world";
+  for (k=0; k<12; k++)
+    mem[k] = txmsg[k];
+
+  // Memory to transmitter, interrupt when done. The whole message
+  // fits in the transmitter fifo, so this finishes right away. The
+  // fifo belongs to the dma meanwhile, a cpu write is dropped (if it
+  // wasn't, the receiver would get 13 characters below).
+  dma_start(0, 12, 0x02);
+  outb('X', UART_TR);
+  b = wb_wait_until(UART_DMA_ST, 0x01, 0x01, 40);
+  GOAL(rtfSimpleUart.irq_o);
+  b = inb(UART_IS);
+  GOAL((b & 0x1c) == 0x14); // dma transfer complete
+  outb (0x00, UART_DMA_ST);   // acknowledge it
+  b = inb(UART_IS);
+  GOAL(!(b & 0x80));        // no interrupt pending
+
+  // Receiver to memory, the characters are moved as they come in.
+  dma_start(32, 12, 0x03);
+  b = wb_wait_until(UART_DMA_ST, 0x01, 0x01, 4000);
+  GOAL(b & 0x01);           // done
+  b = inb(UART_DMA_LN0);
+  GOAL(b == 0);             // nothing left
+  b = inb(UART_LS);
+  GOAL(!(b & 0x01));        // the dma emptied the receiver fifo
+  GOAL(!(b & 0x02));        // no overrun
+
+  for (k=0; k<12; k++)
+    GOAL(mem[32+k] == txmsg[k]);
+
+  // Starting again clears the done bit of the last transfer
+  dma_start(0, 1, 0x00);
+  b = inb(UART_DMA_ST);
+  GOAL(!(b & 0x01));
+  b = wb_wait_until(UART_DMA_ST, 0x01, 0x01, 40);
+  GOAL(b & 0x01);
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+#!/bin/sh
+# ---------------------------------------------------------------------
+# Proof farm: runs harness / proof targets from the Makefile in
+# parallel, one job per target. Every job gets its own directory,
+# farm/<target>/, for its log and waveforms.
+#
+# Results are cached in farm/cache, keyed on a hash of the job's
+# commands and of every source file they read, with the headers the
+# harnesses include (cc -MM, with the job's -D flags), so
+# a target whose harness, rtl and settings haven't changed since it
+# last passed or failed isn't run again.
+#
+#   ./farm.sh [-j jobs] target...
+#
+# make farm runs all of FARM_TARGETS; it builds the interface headers
+# first, so the jobs don't race to generate them. The exit status is
+# non-zero if any target failed, other than the expected failures
+# listed in FARM_XFAIL.
+# ---------------------------------------------------------------------
+
+self=$(cd "$(dirname "$0")" && pwd)/$(basename "$0")
+cd "$(dirname "$self")" || exit 2
+
+FARM=farm
+CACHE=$FARM/cache
+JOBS=$(nproc 2>/dev/null || echo 1)
+
+usage() {
+  echo "usage: $0 [-j jobs] target..." >&2
+  exit 2
+}
+
+# Hash of everything a target depends on
+job_key() {
+  cmds=$(make -n -B -s "$1" OUT=. 2>/dev/null)
+  words=$(echo "$cmds" | tr ' ' '\n' | sort -u)
+  defs=$(echo "$words" | grep '^-D')
+  # the harnesses and what they include; -MG lets the interface
+  # headers hw-cbmc generates be missing
+  deps=$(for f in $words; do
+      case $f in
+      *.c) [ -f "$f" ] && ${CC:-cc} -MM -MG $defs "$f" 2>/dev/null ;;
+      esac
+    done | tr ' \\' '\n\n' | grep -v ':$')
+  {
+    echo "$cmds"
+    for f in $(printf '%s\n%s\n' "$words" "$deps" | sort -u); do
+      [ -f "$f" ] && cat "$f"
+    done
+  } | sha256sum | cut -d' ' -f1
+}
+
+# Run a single target, leaving "<result> <seconds> [cached]" in
+# farm/<target>/result
+job() {
+  t=$1
+  dir=$FARM/$t
+  rm -rf "$dir"
+  mkdir -p "$dir"
+  key=$(job_key "$t")
+
+  if [ -f "$CACHE/$key" ]; then
+    cp "$CACHE/$key.log" "$dir/log"
+    echo "$(cat "$CACHE/$key") cached" > "$dir/result"
+    return
+  fi
+
+  t0=$(date +%s)
+  make -s "$t" OUT="$dir" > "$dir/log" 2>&1
+  rc=$?
+  secs=$(( $(date +%s) - t0 ))
+
+  # hw-cbmc says VERIFICATION FAILED and ebmc REFUTED for a
+  # counterexample; anything else that stops make is a tool or
+  # build error, which isn't cached.
+  if [ $rc -eq 0 ]; then
+    result=PASS
+  elif grep -q "VERIFICATION FAILED\|REFUTED" "$dir/log"; then
+    result=FAIL
+  else
+    result=ERROR
+  fi
+  echo "$result $secs" > "$dir/result"
+  if [ $result != ERROR ]; then
+    cp "$dir/log" "$CACHE/$key.log"
+    echo "$result $secs" > "$CACHE/$key"
+  fi
+}
+
+if [ "$1" = "--job" ]; then
+  job "$2"
+  exit 0
+fi
+
+while getopts j: opt; do
+  case $opt in
+  j) JOBS=$OPTARG ;;
+  *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ $# -gt 0 ] || usage
+
+mkdir -p "$CACHE"
+t0=$(date +%s)
+printf '%s\n' "$@" | xargs -P "$JOBS" -I{} sh "$self" --job {}
+
+xfail=" $(make -s farm_xfail) "
+status=0
+for t in "$@"; do
+  read -r result secs cached < "$FARM/$t/result"
+  case "$xfail" in
+  *" $t "*)
+    if [ $result = FAIL ]; then
+      result=XFAIL
+    elif [ $result = PASS ]; then
+      result=XPASS
+      status=1
+    fi
+    ;;
+  esac
+  [ $result = FAIL ] || [ $result = ERROR ] && status=1
+  printf '%-28s %-6s %6ss %s\n' "$t" $result $secs "$cached"
+done
+echo "total $(( $(date +%s) - t0 ))s"
+
+exit $status
@@ -1,109 +1,101 @@
 #include<assert.h>
-#include "rtfSimpleUart.h"
+#include "wishbone.h"
 
 // ---------------------------------------------------------------------
-// Transactions on the wishbone interface
-// ---------------------------------------------------------------------
-
-void wb_reset(void) {
-  rtfSimpleUart.rst_i = 1;
-  set_inputs();
-  next_timeframe();
-  rtfSimpleUart.rst_i = 0;
-  // Rule 3.20
-  rtfSimpleUart.stb_i = 0; rtfSimpleUart.cyc_i = 0;
-}
-
-void wb_idle() {
-  set_inputs();
-  next_timeframe();
-}
-
-void wb_write(_u32 addr, _u8 b) {
-  // Master presents address, data, asserts WE, CYC and STB
-  rtfSimpleUart.adr_i = addr;
-  rtfSimpleUart.dat_i = b;
-  rtfSimpleUart.we_i = 1;
-  rtfSimpleUart.cyc_i = 1;
-  rtfSimpleUart.stb_i = 1;
-  set_inputs();
-  //assert(rtfSimpleUart.ack_o == 1);
-  // We assume the acknowledge comes right away.
-  // NB Wishbone does not guarantee this in general!
-  // The simple UART appears to derive ack_o combinatorially from stb_i and cyc_i.
-  next_timeframe();
-  rtfSimpleUart.we_i = 0;
-  rtfSimpleUart.cyc_i = 0;
-  rtfSimpleUart.stb_i = 0;
-}
-
-_u8 wb_read(_u32 addr) {
-  // Master presents address, data, asserts CYC and STB, deasserts WE
-  rtfSimpleUart.adr_i = addr;
-  rtfSimpleUart.we_i = 0;
-  rtfSimpleUart.cyc_i = 1;
-  rtfSimpleUart.stb_i = 1;
-  set_inputs();
-  //assert(rtfSimpleUart.ack_o == 1);
-  // We assume the acknowledge comes right away.
-  // NB Wishbone does not guarantee this in general!
-  // The simple UART appears to derive ack_o combinatorially from stb_i and cyc_i.
-  _u8 b = rtfSimpleUart.dat_o;
-  next_timeframe();
-  rtfSimpleUart.we_i = 0;
-  rtfSimpleUart.cyc_i = 0;
-  rtfSimpleUart.stb_i = 0;
-  return b;
-}
-
-// ---------------------------------------------------------------------
-// Linux-style inb, outb
+// Hardware flow control under back-pressure, in loopback mode at the
+// highest rate (a baud tick every other clock).
+//
+// With automatic rts (CTRL bit 4) and cts flow control (CTRL bit 0),
+// the transmitter takes its cts from the receiver's rts. The harness
+// keeps the transmitter fifo topped up with CHARS characters, more
+// than the receiver fifo holds in the native run, while the reader
+// first sleeps for long enough to let the receiver run past the
+// high-water mark, and then reads at an arbitrary pace.
 //
-// Right now, these call wb_read and wb_write directly.
+// While it sleeps, the receiver has to stop the transmitter at the
+// high-water mark (one character more at most, the one on its way
+// out when rts went away), with rts deasserted. After that every
+// character has to arrive, in order, and there must never be an
+// overrun; rts has to be back once the fifo is empty.
 //
-// If/when we decide to run HW and FW in separate threads,
-// inb/outb would execute in the FW thread, wb_read/wb_write would
-// execute in the hardware thread, and communication between them
-// would be via synchronization or fifo channel.
+// The marks are in sixteenths of the receiver fifo, one character for
+// the default 16 deep fifo. hw-cbmc takes arbitrary watermarks below
+// 3, the native run goes through every high-water mark with a random
+// low one.
 // ---------------------------------------------------------------------
 
-typedef unsigned char u8;
-
-unsigned char inb (unsigned long port) {
-  return wb_read(port);
-}
-
-void outb (u8 value, unsigned long port) {
-  wb_write(port, value);
+#define BIT_CLOCKS 32       // 16 ticks, a tick every other clock
+#define CHAR_CLOCKS (10 * BIT_CLOCKS)
+
+#ifdef NATIVE_SIM
+#include <stdlib.h>
+#define nondet_u8() ((u8)rand())
+#define nondet_bool() (rand() & 1)
+#define CHARS 40
+#define MAX_HI 15
+#define RUNS MAX_HI
+#else
+u8 nondet_u8(void);
+_Bool nondet_bool(void);
+#define CHARS 5
+#define MAX_HI 2
+#define RUNS 1
+#endif
+
+static void check_marks(int hi, int lo) {
+  u8 txmsg[CHARS];
+  int sent = 0, got = 0, lazy = 0;
+  int i, k, n;
+  u8 b, overrun = 0;
+
+  for (i=0; i<CHARS; i++)
+    txmsg[i] = nondet_u8();
+
+  outb(lo << 4 | hi, UART_RTSW);
+  GOAL(inb(UART_RTSW) == (lo << 4 | hi));
+
+  // The reader sleeps, the writer keeps going
+  for (n=0; n<(hi + 2) * CHAR_CLOCKS; n++) {
+    b = inb(UART_LS);
+    overrun |= b & 0x02;
+    if (sent < CHARS && (b & 0x20)) {
+      outb(txmsg[sent++], UART_TR);
+      n++;
+    }
+  }
+  GOAL(rtfSimpleUart.rts_no == 1);
+
+  for (k=0; k<=hi + 1 && (inb(UART_LS) & 0x01); k++)
+    GOAL(inb(UART_TR) == txmsg[got++]);
+  GOAL(k >= hi && k <= hi + 1);             // stopped at the mark
+
+  // The reader wakes up, and takes a character when it feels like it
+  // (but within a bit time)
+  for (n=0; got < CHARS && n < 2 * CHARS * CHAR_CLOCKS; n++) {
+    b = inb(UART_LS);
+    overrun |= b & 0x02;
+    if (sent < CHARS && (b & 0x20)) {
+      outb(txmsg[sent++], UART_TR);
+      n++;
+    }
+    if ((b & 0x01) && (nondet_bool() || lazy >= BIT_CLOCKS)) {
+      GOAL(inb(UART_TR) == txmsg[got++]);
+      lazy = 0;
+      n++;
+    }
+    else
+      lazy++;
+  }
+  GOAL(got == CHARS);
+  GOAL(!overrun);
+  wb_idle_n(4);
+  GOAL(rtfSimpleUart.rts_no == 0);
 }
 
-// ---------------------------------------------------------------------
-// UART Firmware
-// ---------------------------------------------------------------------
-
-// UART addresses
-// Some of these are not implemented yet in the opencores UART.
-#define UART_TR 0xffdc0a00         // tx/rx data (RW)
-#define UART_LS (UART_TR + 1)      // line status (RO)
-#define UART_MS (UART_TR + 2)      // modem status (RO)
-#define UART_IS (UART_TR + 3)      // interrupt status (RO)
-#define UART_IE (UART_TR + 4)      // interrupt enable (RW)
-#define UART_FF (UART_TR + 5)      // frame format (RW)
-#define UART_MC (UART_TR + 6)      // modem control (RW)
-#define UART_CR (UART_TR + 7)      // uart control (RW)
-#define UART_CM0 (UART_TR + 8)     // clock multiplier byte 0 - least significant (RW)
-#define UART_CM1 (UART_TR + 9)     //                  byte 1
-#define UART_CM2 (UART_TR + 10)    //                  byte 2
-#define UART_CM3 (UART_TR + 11)    //                  byte 3 - most significant (RW)
-#define UART_FC (UART_TR + 12)     // fifo control (RW)
-#define UART_SPR (UART_TR + 15)    // scratchpad (RW)
-
-// ---------------------------------------------------------------------
-// Main test routine
-// ---------------------------------------------------------------------
-
 int main(void) {
 
+  int i;
+
   // Reset
 
   wb_reset();
@@ -111,59 +103,21 @@ int main(void) {
 
   // Configure the uart
 
-  outb (0x13, UART_MC);  // Loopback mode
-  outb (0x80, UART_CM3); // Hella big clock multiplier!
-  outb (0x00, UART_CM2);
-  outb (0x00, UART_CM1);
-  //  outb (0x00, UART_CR);  // no:  hardware flow control
-  outb (0x02, UART_IE);  // yes: tx_empty interrupts 
-
-  // Now the Uart is configured in loopback mode with tx_empty
-  // interrupts enabled. We just have to wait for the first
-  // interrupt, which will be a tx interrupt, and start sending and
-  // receiving data.
-
-  char *msg = "Hello world";
-  _u8 *tx_b=msg, rx_b=0, istatus = 0;
-  int i;
-
-  for (i=0; i<390; i++) {
-
-    if (rtfSimpleUart.irq_o) {
-
-      istatus = inb(UART_IS) & 0x0c;
-      if (istatus == 0x0c) {
-        // it was a tx_empty interrupt
-        outb(*tx_b, UART_TR);
-        tx_b++;
-      } else { // istatus==0x04
-        // it was an rx_data interrupt
-  /*
-        rx_b = inb(UART_TR);
-  */
-        wb_idle();
-      }
-
-    } else {
-
-      // no interrupt. 
-      // Note, same number of RTL clocks in each arm of if
-      wb_idle();
-      wb_idle();
-
-    }
-
+  static const struct uart_reg config[] = {
+    { UART_MC, 0x13 },      // Loopback mode
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_CR, 0x11 },      // yes: automatic rts, hardware flow control
+    { UART_IE, 0x00 },      // no:  interrupts, we poll
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+  GOAL(inb(UART_RTSW) == 0x4c);             // 3/4 and 1/4 from reset
+
+  for (i=0; i<RUNS; i++) {
+    int hi = RUNS > 1 ? i + 1 : 1 + nondet_u8() % MAX_HI;
+    check_marks(hi, nondet_u8() % hi);
   }
 
-  rx_b = inb(UART_TR);
-  wb_idle();
-  rx_b = inb(UART_TR);
-  wb_idle();
-  rx_b = inb(UART_TR);
-  wb_idle();
-
-  // Failing assertion, so as to generate some waveforms
-  assert(0);
-
   return 0;
 }
@@ -0,0 +1,141 @@
+#!/bin/sh
+# ---------------------------------------------------------------------
+# Goal driver: solves every GOAL() of a harness (see wishbone.h) as a
+# separate hw-cbmc run, in parallel, each with the smallest bound that
+# reaches it, and reports the status and time of each goal. The early
+# goals of a long harness finish early, and a slow one shows up on its
+# own line instead of hiding in one big run.
+#
+#   ./goals.sh [-j jobs] [-s slack] [-r seeds] harness
+#   ./goals.sh [-j jobs] -n goals -b bound harness
+#
+# The goals and the clock each one is reached at come from native runs
+# of the harness (make <harness>_native), one per seed (default 4,
+# NATIVE_SEED=1..seeds): the harnesses that draw nondet values take
+# different paths with each. A goal's bound is the latest clock any
+# of the runs reached it at, plus slack (default 50) timeframes.
+# Without verilator, give the number of goals and a bound to use for
+# all of them.
+#
+# The bound is only a guess at the path hw-cbmc will find, so a goal
+# that passes is run once more with -DGOAL_REACH (as in deepen.sh):
+#   PASS       the goal holds, and is reached within the bound
+#   UNREACHED  no path reaches it within the bound, the pass says
+#              nothing; give more slack or seeds, or use deepen.sh
+#   FAIL       counterexample, see the waveform
+#   ERROR      hw-cbmc didn't finish, see the log
+#
+# Logs and waveforms go to goals/<harness>/<goal>/. The exit status is
+# non-zero unless every goal passed.
+# ---------------------------------------------------------------------
+
+self=$(cd "$(dirname "$0")" && pwd)/$(basename "$0")
+cd "$(dirname "$self")" || exit 2
+
+GOALS=goals
+JOBS=$(nproc 2>/dev/null || echo 1)
+SLACK=50
+SEEDS=4
+NGOALS=
+BOUND=
+
+usage() {
+  echo "usage: $0 [-j jobs] [-s slack] [-r seeds] [-n goals -b bound] harness" >&2
+  exit 2
+}
+
+# One hw-cbmc run of goal $2 of harness $1 at bound $3 into $4, the
+# result (PASS, FAIL or ERROR) on stdout; the rest are make variables
+solve() {
+  h=$1; n=$2; b=$3; dir=$4
+  shift 4
+  mkdir -p "$dir"
+  make -s "${h}_goal" GOAL_ONLY="$n" GOAL_BOUND="$b" OUT="$dir" "$@" > "$dir/log" 2>&1
+  rc=$?
+  if [ $rc -eq 0 ]; then
+    echo PASS
+  elif grep -q "VERIFICATION FAILED" "$dir/log"; then
+    echo FAIL
+  else
+    echo ERROR
+  fi
+}
+
+# Solve goal $2 of harness $1 at bound $3, leaving
+# "<result> <bound> <seconds>" in goals/<harness>/<goal>/result
+job() {
+  dir=$GOALS/$1/$2
+  rm -rf "$dir"
+
+  t0=$(date +%s)
+  result=$(solve "$1" "$2" "$3" "$dir")
+  if [ "$result" = PASS ]; then
+    case $(solve "$1" "$2" "$3" "$dir/reach" GOAL_FLAGS=-DGOAL_REACH) in
+    FAIL) ;;
+    PASS) result=UNREACHED ;;
+    *) result=ERROR ;;
+    esac
+  fi
+  secs=$(( $(date +%s) - t0 ))
+
+  echo "$result $3 $secs" > "$dir/result"
+}
+
+if [ "$1" = "--job" ]; then
+  job "$2" "$3" "$4"
+  exit 0
+fi
+
+while getopts j:s:r:n:b: opt; do
+  case $opt in
+  j) JOBS=$OPTARG ;;
+  s) SLACK=$OPTARG ;;
+  r) SEEDS=$OPTARG ;;
+  n) NGOALS=$OPTARG ;;
+  b) BOUND=$OPTARG ;;
+  *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 1 ] || usage
+h=$1
+
+mkdir -p "$GOALS/$h"
+plan=$GOALS/$h/plan
+
+# One "<goal> <bound>" line per goal
+if [ -n "$NGOALS" ]; then
+  [ -n "$BOUND" ] || usage
+  seq 1 "$NGOALS" | sed "s/\$/ $BOUND/" > "$plan"
+else
+  rm -f "$GOALS/$h"/native.*.log
+  for s in $(seq 1 "$SEEDS"); do
+    NATIVE_SEED=$s make -s "${h}_native" > "$GOALS/$h/native.$s.log" 2>&1
+  done
+  cat "$GOALS/$h"/native.*.log |
+    sed -n 's/^goal \([0-9]*\): cycle \([0-9]*\).*/\1 \2/p' |
+    awk -v slack="$SLACK" '
+      !($1 in c) || $2 > c[$1] { c[$1] = $2 }
+      END { for (n in c) print n, c[n] + slack }' |
+    sort -n > "$plan"
+  if [ ! -s "$plan" ]; then
+    echo "$0: no goals from the native runs of $h, see $GOALS/$h/native.*.log" >&2
+    exit 2
+  fi
+fi
+
+# Interface headers first, so the jobs don't race to generate them
+make -s rtfSimpleUart.h rtfSimpleUartWithDma.h rtfSimpleUartAbstractBaud.h || exit 2
+
+t0=$(date +%s)
+sed "s|^|$h |" "$plan" | xargs -P "$JOBS" -L 1 sh "$self" --job
+
+status=0
+while read -r n bound; do
+  read -r result bound secs < "$GOALS/$h/$n/result"
+  [ $result = PASS ] || status=1
+  printf '%-20s goal %-4s bound %-6s %-9s %6ss\n' "$h" "$n" "$bound" $result "$secs"
+done < "$plan"
+echo "total $(( $(date +%s) - t0 ))s"
+
+exit $status
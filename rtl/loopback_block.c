@@ -0,0 +1,57 @@
+#include<assert.h>
+#include <string.h>
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Main test routine
+
+int main(void) {
+
+  _u8 b;
+  int k;
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+
+  // Configure the uart
+
+  static const struct uart_reg config[] = {
+    { UART_MC, 0x13 },      // Loopback mode
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_CR, 0x00 },      // no:  hardware flow control
+    { UART_IE, 0x00 },      // no:  interrupts, we poll
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+
+  unsigned char txmsg[12] = "Hello world";
+  unsigned char rxmsg[12] = "0123456789a";
+
+  // Fill the transmit fifo with one block write
+  wb_block_write(UART_TR, txmsg, 12);
+  b = inb(UART_LS);
+  GOAL(b & 0x20); // still room in the fifo
+  GOAL(~b & 0x40); // tx not empty
+
+  // Wait for the whole message to go out, then one more bit time
+  // for the receiver to take the last stop bit
+  b = wb_wait_until(UART_LS, 0x40, 0x40, 4000);
+  wb_idle_n(32);
+  b = inb(UART_LS);
+  GOAL(b & 0x40); // tx empty
+  GOAL(b & 0x01); // data ready
+  GOAL(!(b & 0x02)); // no overrun
+
+  // Drain the receive fifo with one block read
+  wb_block_read(UART_TR, rxmsg, 12);
+  b = inb(UART_LS);
+  GOAL(!(b & 0x01)); // fifo is empty now
+
+  for(k=0; k<12; k++)
+    GOAL(rxmsg[k] == txmsg[k]);
+
+  return 0;
+}
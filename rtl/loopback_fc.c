@@ -0,0 +1,83 @@
+#include<assert.h>
+#include <string.h>
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Main test routine
+// ---------------------------------------------------------------------
+
+int main(void) {
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+
+  // Configure the uart
+
+  static const struct uart_reg config[] = {
+    { UART_MC, 0x13 },      // Loopback mode
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_CR, 0x00 },      // no:  hardware flow control
+    { UART_FC, 0x1b },      // trigger levels: rx fifo half full, tx fifo empty
+    { UART_IE, 0x03 },      // yes: tx_empty and rx_data interrupts
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+
+  // With a 16 entry receive fifo, the first 8 characters of the
+  // message are picked up on a single rx_data interrupt. The last 4
+  // never reach the trigger level and have to be flushed by the
+  // character timeout.
+
+  unsigned char txmsg[12] = "Hello world";
+  unsigned char rxmsg[12] = "0123456789a";
+  _u8 istatus = 0;
+  int i;
+  int j=0, k=0;
+  int rx_irqs=0, timeouts=0;
+
+  for (i=0; i<2700 && k<12; i++) {
+
+    if (rtfSimpleUart.irq_o && k<12) {
+
+      istatus = inb(UART_IS) & 0x1c;
+      if (istatus == 0x0c) {
+        // it was a tx_empty interrupt
+        while (j<12 && (inb(UART_LS) & 0x20)) {
+          outb(txmsg[j], UART_TR);
+          j++;
+        }
+        if (j==12)
+          outb(0x01, UART_IE); // nothing left to send: rx_data only
+      } else {
+        // rx_data (0x04) or character timeout (0x08) interrupt
+        if (istatus == 0x08)
+          timeouts++;
+        else
+          rx_irqs++;
+        while (k<12 && (inb(UART_LS) & 0x01)) {
+          rxmsg[k] = inb(UART_TR);
+          GOAL(rxmsg[k] == txmsg[k]); // checked as it arrives
+          k++;
+        }
+      }
+
+    } else {
+
+      // no interrupt. 
+      // Note, same number of RTL clocks in each arm of if
+      wb_idle();
+      wb_idle();
+
+    }
+
+  }
+
+  GOAL(k == 12); // the whole message came back
+  GOAL(rx_irqs == 1);
+  GOAL(timeouts == 1);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include<assert.h>
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Frame formats (FF register): 5 to 8 data bits, no, odd or even
+// parity, 1 or 2 stop bits.
+//
+// For a format, a character first goes around in loopback mode and
+// has to come back with its data bits and without a framing or parity
+// error. Then, with loopback off, the transmitter is checked against
+// the format bit by bit on txd_o, and the receiver against a frame the
+// harness sends on rxd_i, with the parity bit right or wrong; a wrong
+// one has to show up in LS bit 2.
+//
+// hw-cbmc takes an arbitrary format, character and parity, so one run
+// covers every format. The native run goes through all 32 values of
+// FF with random characters.
+// ---------------------------------------------------------------------
+
+#define BIT_CLOCKS 32       // 16 ticks, a tick every other clock
+
+#ifdef NATIVE_SIM
+#include <stdlib.h>
+#define nondet_u8() ((u8)rand())
+#define FORMATS 32
+#else
+u8 nondet_u8(void);
+#define FORMATS 1
+#endif
+
+static inline int data_bits(u8 ff) { return 5 + (ff & 3); }
+static inline int stop_bits(u8 ff) { return 1 + ((ff >> 2) & 1); }
+static inline int parity_en(u8 ff) { return (ff >> 3) & 1; }
+
+// The parity bit for c, even parity makes the ones even
+static inline int parity(u8 ff, u8 c) {
+  int i, p = !((ff >> 4) & 1);
+  for (i=0; i<data_bits(ff); i++)
+    p ^= (c >> i) & 1;
+  return p;
+}
+
+// The transmitter sends c in format ff on txd_o, sampled in the
+// middle of every bit
+static void check_txd(u8 ff, u8 c) {
+  int i, n = 0;
+
+  outb(c, UART_TR);
+  while (rtfSimpleUart.txd_o && n < 2 * BIT_CLOCKS) {
+    wb_idle();
+    n++;
+  }
+  wb_idle_n(BIT_CLOCKS / 2);
+  GOAL(rtfSimpleUart.txd_o == 0);                 // start
+  for (i=0; i<data_bits(ff); i++) {
+    wb_idle_n(BIT_CLOCKS);
+    GOAL(rtfSimpleUart.txd_o == ((c >> i) & 1));
+  }
+  if (parity_en(ff)) {
+    wb_idle_n(BIT_CLOCKS);
+    GOAL(rtfSimpleUart.txd_o == parity(ff, c));
+  }
+  for (i=0; i<stop_bits(ff); i++) {
+    wb_idle_n(BIT_CLOCKS);
+    GOAL(rtfSimpleUart.txd_o == 1);
+  }
+}
+
+// Send c in format ff on rxd_i, with the parity bit flipped if bad
+static void send_rxd(u8 ff, u8 c, int bad) {
+  int i;
+
+  rtfSimpleUart.rxd_i = 0;                        // start
+  wb_idle_n(BIT_CLOCKS);
+  for (i=0; i<data_bits(ff); i++) {
+    rtfSimpleUart.rxd_i = (c >> i) & 1;
+    wb_idle_n(BIT_CLOCKS);
+  }
+  if (parity_en(ff)) {
+    rtfSimpleUart.rxd_i = parity(ff, c) ^ bad;
+    wb_idle_n(BIT_CLOCKS);
+  }
+  rtfSimpleUart.rxd_i = 1;
+  wb_idle_n(BIT_CLOCKS * stop_bits(ff));
+}
+
+static void check_format(u8 ff, u8 c, int bad) {
+  u8 mask = 0xff >> (8 - data_bits(ff));
+  u8 b;
+
+  outb(ff, UART_FF);
+  GOAL(inb(UART_FF) == ff);
+
+  // Loopback
+  outb(0x13, UART_MC);
+  outb(c, UART_TR);
+  b = wb_wait_until(UART_LS, 0x01, 0x01, 13 * BIT_CLOCKS);
+  GOAL(b & 0x01);
+  GOAL(!(b & 0x0c));        // no framing or parity error
+  GOAL(inb(UART_TR) == (c & mask));
+  wb_wait_until(UART_LS, 0x40, 0x40, 3 * BIT_CLOCKS);
+
+  // The transmitter on its own
+  outb(0x03, UART_MC);
+  check_txd(ff, c);
+
+  // The receiver on its own
+  send_rxd(ff, c, bad);
+  b = wb_wait_until(UART_LS, 0x01, 0x01, BIT_CLOCKS);
+  GOAL(b & 0x01);
+  GOAL(!(b & 0x08));
+  GOAL(!!(b & 0x04) == (bad && parity_en(ff)));
+  GOAL(inb(UART_TR) == (c & mask));
+}
+
+int main(void) {
+
+  int i;
+
+  rtfSimpleUart.rxd_i = 1;
+  rtfSimpleUart.cts_ni = 0;
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+  GOAL(inb(UART_FF) == 0x03);                     // 8N1
+
+  // Configure the uart
+
+  static const struct uart_reg config[] = {
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_CR, 0x00 },      // no:  hardware flow control
+    { UART_IE, 0x00 },      // no:  interrupts, we poll
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+
+  for (i=0; i<FORMATS; i++) {
+    u8 ff = FORMATS > 1 ? i : nondet_u8() & 0x1f;
+    check_format(ff, nondet_u8(), nondet_u8() & 1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+#include<assert.h>
+#include "wishbone.h"
+
+// ---------------------------------------------------------------------
+// Loopback in both oversampling modes, 16x first and then 8x (CTRL
+// bit 1), switched while the transmitter is still finishing the last
+// 16x stop bit. The clock multiplier is the same for both, a baud
+// tick every other clock, so a bit is 32 clocks at 16x and 16 at 8x.
+//
+// Every character has to come back intact, without a framing error,
+// and within 11 bit times of being written. At 8x that is less than
+// a 16x frame takes, so the line really runs at twice the rate.
+// ---------------------------------------------------------------------
+
+#define BIT_CLOCKS(x8) ((x8) ? 16 : 32)
+
+static const unsigned char txmsg[2][2] = {
+  { 0xa5, 0x3c },           // 16x
+  { 0x5a, 0xc3 },           // 8x
+};
+
+int main(void) {
+
+  int x8, i, n;
+  _u8 b;
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+
+  // Configure the uart
+
+  static const struct uart_reg config[] = {
+    { UART_MC, 0x13 },      // Loopback mode
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_IE, 0x00 },      // no:  interrupts, we poll
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+
+  for (x8=0; x8<2; x8++) {
+
+    outb(x8 << 1, UART_CR);   // no hardware flow control, 16x or 8x
+
+    for (i=0; i<2; i++) {
+      outb(txmsg[x8][i], UART_TR);
+      // One clock per read, so n counts the clocks
+      n = 1;
+      b = inb(UART_LS);
+      while (!(b & 0x01) && n < 11 * BIT_CLOCKS(x8)) {
+        b = inb(UART_LS);
+        n++;
+      }
+      GOAL(b & 0x01);         // back within 11 bit times
+      GOAL(!(b & 0x08));      // no framing error
+      b = inb(UART_TR);
+      GOAL(b == txmsg[x8][i]);
+    }
+  }
+
+  return 0;
+}
@@ -37,7 +37,7 @@
 //  	clock (clk_i). This can be done when the core is instanced.
 // 
 //    1) set the baud rate value in the clock multiplier
-//    registers (CM1,2,3). A default multiplier value may
+//    registers (CM0,1,2,3). A default multiplier value may
 //    be specified using the pClkMul parameter, so it
 //    doesn't have to be programmed at run time. (Note the
 //    pBaud parameter may also be set, but it doesn't work
@@ -53,15 +53,24 @@
 //    for communication.
 //
 //    Notes:
-//    	This core only supports a single transmission /
-//    reception format: 1 start, 8 data, and 1 stop bit (no
-//    parity).	
-//    	The baud rate generator uses a 24 bit harmonic
-//    frequency synthesizer. Compute the multiplier value
-//    as if a 32 bit value was needed, then take the upper
-//    24 bits of the value. (The number of significant bits
-//    in the value determine the minimum frequency
-//    resolution or the precision of the value).
+//    	Received characters are buffered in a fifo. The depth
+//    is 2**pRxFifoAddrWidth characters (16 by default). The
+//    receive interrupt stays active until the fifo has been
+//    emptied.
+//    	Characters to be sent are queued in a transmit fifo,
+//    2**pTxFifoAddrWidth characters deep (16 by default). The
+//    transmit interrupt is raised when the fifo runs empty, so
+//    the fifo may be refilled while the last character is
+//    still being shifted out.
+//    	The frame format is set in the FF register: 5 to 8
+//    data bits, no, even or odd parity, and 1 or 2 stop
+//    bits. It defaults to 1 start, 8 data, and 1 stop bit
+//    (no parity).	
+//    	The baud rate generator uses a 32 bit harmonic
+//    frequency synthesizer (pBaudWidth bits, see below).
+//    (The number of significant bits in the value determine
+//    the minimum frequency resolution or the precision of
+//    the value).
 //
 //    				baud rate * 16
 //    	value = -----------------------
@@ -74,18 +83,20 @@
 //				= 92149557.65
 //				= 057E1736 (hex)
 //				
-//				
-//		taking the upper 24 bits
-//				top 24 = 057E17
-//						= 359959
-//				
 //		so the value needed to be programmed into the register
-//	for 38.4k baud is 57E17 (hex)
-//		eg 	CM0 = 0 (not used)
+//	for 38.4k baud is 57E1736 (hex)
+//		eg 	CM0 = 36 hex
 //			CM1 = 17 hex
 //			CM2 = 7E hex
 //			CM3 = 05 hex
 //
+//		The 16x clock is then within clk_i / 2^32 of the
+//	wanted frequency, 0.007 Hz here. The accumulator can be
+//	narrowed with the pBaudWidth parameter to save flip-flops;
+//	it then uses the upper pBaudWidth bits of the value and the
+//	resolution drops to clk_i / 2^pBaudWidth (pBaudWidth = 24
+//	ignores CM0, the original 24 bit generator).
+//
 //
 //	Register Description
 //
@@ -100,14 +111,19 @@
 //		LS	- line status register
 //		bit 0 = receiver not empty, this bit is set if there is
 //				any data available in the receiver fifo
-//		bit 1 = overrun, this bit is set if receiver overrun occurs
+//		bit 1 = overrun, this bit is set if a character arrived
+//				while the receiver fifo was full (the character is
+//				discarded)
+//		bit 2 = parity error, this bit is set if the parity bit
+//				of the last character received was wrong
 //		bit 3 = framing error, this bit is set if there was a
 //				framing error with the current byte in the receiver
 //				buffer.
 //		bit 5 = transmitter not full, this bit is set if the transmitter
-//				can accept more data
+//				fifo can accept more data
 //		bit 6 = transmitter empty, this bit is set if the transmitter is
-//				completely empty
+//				completely empty (fifo empty and the last character
+//				has been shifted out)
 //
 //	2	MS	- modem status register (RO)
 //		writing to the modem status register clears the change
@@ -122,6 +138,12 @@
 //		bit 0-4 = mailbox number
 //		bit 0,1	= 00
 //		bit 2-4	= encoded interrupt value
+//				1 = receiver fifo not empty (or at the
+//					trigger level)
+//				2 = receiver character timeout
+//				3 = transmitter fifo empty
+//				4 = modem status change
+//				5 = dma transfer complete
 //		bit 5-6 = not used, reserved
 //		bit 7 = 1 = interrupt pending, 0 = no interrupt
 //
@@ -132,19 +154,48 @@
 //		bit 4-7 = unused, reserved
 //
 //	5	FF	- frame format register		(RW)
-//		this register doesn't do anything in the simpleUart
-//		but is reserved for compatiblity with the more
-//		advanced uart
+//		bit 0-1 = data bits - 5 (0 = 5 ... 3 = 8)
+//		bit 2 = two stop bits (the receiver checks the first)
+//		bit 3 = parity enable
+//		bit 4 = 1 = even parity, 0 = odd parity
+//		resets to 03 hex, 8 data bits, no parity, 1 stop bit.
+//		A change takes effect with the next character; characters
+//		with fewer than 8 data bits read back with the upper bits 0.
 //
 //	6	MC	- modem control register (RW)
 //		bit 0 = dtr signal level output
-//		bit 1 = rts signal level output
+//		bit 1 = rts signal level output (with CTRL bit 4 set the
+//				receiver also takes rts away while its fifo is
+//				above the high-water mark, see RTSW)
 //              bit 4 = internal loopback mode
 //
 //	7	- control register
 //		bit 0 = hardware flow control,
 //			when this bit is set, the transmitter output is
 //			controlled by the cts signal line automatically
+//		bit 1 = 8x oversampling (baud8x),
+//			when this bit is set a bit time is 8 ticks of the
+//			baud rate generator instead of 16, so the same
+//			clock multiplier gives twice the baud rate. The
+//			receiver samples in the middle of each bit either
+//			way. A change takes effect with the next character.
+//		bit 2 = majority sampling, the receiver takes the line
+//			as two out of three consecutive clocks, which
+//			filters out glitches of a single clock on rxd_i
+//		bit 3 = autobaud, writing a one arms it: the next
+//			character on the line has to be a 0x55 ('U'), which
+//			is timed instead of received, and the clock
+//			multiplier for its baud rate is loaded into CM0-CM3
+//			(for the oversampling mode in bit 1). Reads as one
+//			until the sync character is over; writing a zero
+//			disarms it. See rtfSimpleUartAutobaud.v.
+//		bit 4 = automatic rts, when this bit is set rts is
+//			deasserted once the receiver fifo is filled up to
+//			RTSW.high and asserted again once it is down to
+//			RTSW.low, so a peer doing cts flow control doesn't
+//			overrun the fifo. In loopback mode the transmitter
+//			takes its cts from this rts (with the bit clear,
+//			from the receiver fifo being full).
 //
 //
 //		* Clock multiplier steps the 16xbaud clock frequency
@@ -152,22 +203,22 @@
 //		harmonic frequency synthesizer
 //		eg. to get a 9600 baud 16x clock (153.6 kHz) with a
 //		27.175 MHz clock input,
-//		value  = upper24(9600 * 16  / (27.175MHz / 2^32))
+//		value  = 9600 * 16  / (27.175MHz / 2^32)
 //		Higher frequency baud rates will exhibit more jitter
 //		on the 16x clock, but this will mostly be masked by the 
-//		16x clock factor.
+//		16x clock factor. In 8x mode (CTRL bit 1) use 8 in place
+//		of 16: the same 16x clock gives 19200 baud.
 //
 //	8	CM0	- Clock Multiplier byte 0 (RW)
 //		this is the least significant byte
 //		of the clock multiplier value
-//		this register is not used unless the clock
-//		multiplier is set to contain 32 bit values
+//		it is read back as written (or as autobaud left it),
+//		but not used unless
+//		the accumulator is wider than 24 bits (pBaudWidth)
 //
 //	9	CM1 - Clock Multiplier byte 1	(RW)
 //		this is the third most significant byte
 //		of the clock multiplier value
-//		this register is not used unless the clock
-//		multiplier is set to contain 24 or 32 bit values
 //
 //	10	CM2 - Clock Multiplier byte 2	(RW)
 //		this is the second most significant byte of the clock
@@ -177,14 +228,58 @@
 //		this is the most significant byte of the multiplier value
 //
 //	12	FC	- Fifo control register		(RW)
-//		this register doesnt' do anything in the simpleUart
-//		but is reserved for compatibility with the more
-//		advanced uart
+//		bit 0 = enable fifo trigger levels and the receive
+//				character timeout. When this bit is clear the
+//				receive interrupt is raised whenever there is data
+//				in the receiver fifo and the transmit interrupt
+//				when the transmitter fifo is empty.
+//		bit 1-2 = receive trigger level, the receive interrupt is
+//				raised once the receiver fifo is at least
+//				00 = 1/4, 01 = 1/2, 10 = 3/4, 11 = completely full
+//				(at least one character, for a two deep fifo)
+//		bit 3-4 = transmit trigger level, the transmit interrupt is
+//				raised while at least
+//				00 = 1/4, 01 = 1/2, 10 = 3/4, 11 = all
+//				of the transmitter fifo entries are free
+//		bit 5-7 = unused, reserved
+//
+//		With the trigger levels enabled, the receive interrupt
+//		enable also enables the character timeout interrupt. It
+//		is raised when there is data in the receiver fifo, but
+//		nothing has been received or read for four character
+//		times, so that the tail of a burst below the trigger
+//		level is not left sitting in the fifo. Reading the
+//		receive buffer clears it.
 //		
-//	13-14	reserved registers
+//	13	reserved register, writing to it clears the receiver
+//
+//	14	RTSW	- rts watermark register (RW)
+//		The marks are in sixteenths of the receiver fifo depth,
+//		as the trigger levels in FC are in quarters, so they
+//		mean the same for any pRxFifoAddrWidth. For the default
+//		16 deep fifo a sixteenth is one character.
+//		bit 0-3 = high-water mark, rts is deasserted while the
+//				receiver fifo is filled to at least this level
+//				(rounded up to whole characters)
+//		bit 4-7 = low-water mark, rts is asserted again once the
+//				fifo is down to this level (rounded down)
+//		resets to 4C hex, 3/4 and 1/4 of the fifo. Used with
+//		CTRL bit 4. The
+//		transmitter checks cts once per character, so the peer
+//		may still send the character it has started, and
+//		whatever is in its own pipeline; the high-water mark
+//		should leave room for that below the fifo depth. The
+//		high-water mark has to be above the low one, and not 0.
 //
 //	15	SPR	- scratch pad register (RW)
 //
+//	16-23	DMA	- dma registers (when pDma = 1)
+//		the dma engine has its own register window following the
+//		uart registers. See rtfSimpleUartDma.v for the register
+//		description. It moves a buffer between memory and the
+//		transmitter / receiver fifo through the WISHBONE master
+//		port (m_*_o, m_*_i).
+//
 //
 //   	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 //	|WISHBONE Datasheet
@@ -197,6 +292,8 @@
 //	|Supported Cycles:					SLAVE,READ/WRITE
 //	|									SLAVE,BLOCK READ/WRITE
 //	|									SLAVE,RMW
+//	|									SLAVE,PIPELINED READ/WRITE
+//	|									(B4, when pPipelined = 1)
 //	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 //	|Data port, size:					8 bit
 //	|Data port, granularity:			8 bit
@@ -216,9 +313,29 @@
 //	|									cyc_i			CYC_I
 //	|									stb_i			STB_I
 //	|									we_i			WE_I
+//	|									stall_o			STALL_O
+//	|
+//	|	DMA master port (pDma = 1)		m_ack_i			ACK_I
+//	|									m_adr_o[31:0]	ADR_O()
+//	|									m_dat_i(7:0)	DAT_I()
+//	|									m_dat_o(7:0)	DAT_O()
+//	|									m_cyc_o			CYC_O
+//	|									m_stb_o			STB_O
+//	|									m_we_o			WE_O
 //	|
 //	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 //	|Special requirements:
+//	|	Block cycles are intended for the transmit / receive
+//	|	buffer: each acknowledged beat writes one character to
+//	|	the transmitter fifo or reads one from the receiver
+//	|	fifo. The acknowledge is combinatorial, so a block of N
+//	|	beats takes N clocks. The master should check the fifo
+//	|	status first, as beats written to a full transmitter
+//	|	fifo are dropped and beats read from an empty receiver
+//	|	fifo return zero.
+//	|	In pipelined mode (pPipelined = 1) ACK_O and DAT_O are
+//	|	registered and follow the request by one clock. STALL_O
+//	|	is never asserted, so one transfer completes per clock.
 //	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 //
 //=============================================================================
@@ -236,6 +353,7 @@
 `define UART_CLKM2	4'd10	// clock multiplier byte 2
 `define UART_CLKM3	4'd11	// clock multiplier byte 3
 `define UART_FC     4'd12   // fifo control register
+`define UART_RTSW	4'd14	// rts watermark register
 `define UART_SPR     4'd15   // scratchpad register (added by joleary)
 
 module rtfSimpleUart(
@@ -247,65 +365,149 @@ module rtfSimpleUart(
 	input we_i,			// 1 = write
 	input [31:0] adr_i,		// register address
 	input [7:0] dat_i,		// data input bus
-	output reg [7:0] dat_o,	// data output bus
+	output [7:0] dat_o,	// data output bus
 	output ack_o,		// transfer acknowledge
+	output stall_o,		// pipeline stall (pipelined mode)
 	output vol_o,		// volatile register selected
 	output irq_o,		// interrupt request
 	//----------------
 	input cts_ni,		// clear to send - active low - (flow control)
-	output reg rts_no,	// request to send - active low - (flow control)
+	output rts_no,		// request to send - active low - (flow control)
 	input dsr_ni,		// data set ready - active low
 	input dcd_ni,		// data carrier detect - active low
 	output reg dtr_no,	// data terminal ready - active low
 	input rxd_i,			// serial data in
 	output txd_o,			// serial data out
-	output data_present_o
+	output data_present_o,
+	input baud16_i,			// abstract 16x baud clock enable (pAbstractBaud = 1)
+	//----------------
+	// WISHBONE Master interface (dma)
+	output m_cyc_o,		// cycle valid
+	output m_stb_o,		// strobe
+	output m_we_o,		// 1 = write
+	output [31:0] m_adr_o,	// memory address
+	output [7:0] m_dat_o,	// data to memory
+	input [7:0] m_dat_i,	// data from memory
+	input m_ack_i		// transfer acknowledge
 );
 parameter pClkFreq = 20000000;	// clock frequency in MHz
 parameter pBaud = 19200;
-parameter pClkMul = (4096 * pBaud) / (pClkFreq / 65536);
+parameter pClkMul = (4096 * pBaud) / (pClkFreq / 65536) * 256;	// 32 bit multiplier, the 24 bit value scaled up
+parameter pBaudWidth = 32;	// baud rate accumulator width, 24..32 (the upper bits of the multiplier)
 parameter pRts = 1;		// default to active
 parameter pDtr = 1;
+parameter pRxFifoAddrWidth = 4;	// receive fifo depth is 2**pRxFifoAddrWidth (at least 2)
+parameter pTxFifoAddrWidth = 4;	// transmit fifo depth is 2**pTxFifoAddrWidth (at least 2)
+parameter pPipelined = 0;	// 1 = Wishbone B4 pipelined slave interface
+parameter pDma = 0;			// 1 = include the dma engine
+parameter pAbstractBaud = 0;	// 1 = baud16_i replaces the baud rate generator (verification only)
 
 wire cs = cyc_i && stb_i && (adr_i[31:4]==28'hFFDC_0A0);
-assign ack_o = cs;
+wire dma_cs = pDma && cyc_i && stb_i && adr_i[31:3]==29'h1FFB_8142;
+
+// Classic cycles are acknowledged combinatorially. In pipelined
+// mode the acknowledge is registered and comes back on the clock
+// after the request. Every request completes in a single clock,
+// so the core never needs to stall the master. A master that drops
+// cyc_i before the acknowledge has abandoned the cycle, so the
+// registered acknowledge is only given while cyc_i is still up.
+reg ack_r;
+always @(posedge clk_i)
+	if (rst_i)
+		ack_r <= 1'b0;
+	else
+		ack_r <= cs | dma_cs;
+
+assign ack_o = pPipelined ? ack_r & cyc_i : (cs | dma_cs);
+assign stall_o = 1'b0;
 assign vol_o = cs && adr_i[3:2]==2'b00;
 
 //-------------------------------------------
 // variables
-reg [23:0] c;	// current count
-reg [23:0] ck_mul;	// baud rate clock multiplier
+reg [31:0] ck_mul;	// baud rate clock multiplier
 reg [7:0] spr;
-wire tx_empty;
+wire tx_empty;		// transmit fifo empty
+wire tx_full;		// transmit fifo full
+wire tx_done;		// transmitter shift register idle
 wire baud16;	// edge detector (active one cycle only!)
 reg rx_present_ie;
 reg tx_empty_ie;
 reg dcd_ie;
 reg hwfc;			// hardware flow control enable
+reg baud8x;			// 8x oversampling
+reg majority;		// receiver majority sampling
+wire ab_busy;		// autobaud armed or timing the sync character
+wire ab_ld;			// autobaud multiplier ready
+wire [31:0] ab_ck_mul;
+reg autorts;		// automatic rts from the receiver fifo level
+reg rts_n;			// rts from the modem control register
+reg [3:0] rts_hi;	// rts high-water mark
+reg [3:0] rts_lo;	// rts low-water mark
+reg rts_off;		// receiver fifo above the high-water mark
+reg [4:0] ff;		// frame format
 reg loopback;    // loopback enabled
-wire clear = cyc_i && stb_i && we_i && adr_i[3:0]==4'd13;
+wire clear = cs && we_i && adr_i[3:0]==4'd13;
 wire frame_err;		// receiver char framing error
+wire parity_err;	// receiver char parity error
 wire over_run;		// receiver over run
+wire rx_full;		// receiver fifo full
+wire [pRxFifoAddrWidth:0] rx_cnt;	// characters in receiver fifo
+wire [pTxFifoAddrWidth:0] tx_cnt;	// characters in transmitter fifo
+wire rx_timeout;	// receiver character timeout
+reg fifo_trig;		// fifo trigger levels enabled
+reg [1:0] rx_trig;	// receiver fifo trigger level
+reg [1:0] tx_trig;	// transmitter fifo trigger level
+wire [7:0] dma_do;	// dma register read data
+wire dma_tx_own;	// dma transfer owns the transmitter fifo
+wire dma_tx_wr;		// dma writes to transmitter fifo
+wire [7:0] dma_tx_dat;
+wire dma_rx_own;	// dma transfer owns the receiver fifo
+wire dma_rx_rd;		// dma reads from receiver fifo
+wire [7:0] dma_rx_dat;
 reg [1:0] ctsx;		// cts_ni sampling
 reg [1:0] dcdx;
 reg [1:0] dsrx;
 wire dcd_chg = dcdx[1]^dcdx[0];
 
 
-wire rxIRQ = data_present_o & rx_present_ie;
-wire txIRQ = tx_empty & tx_empty_ie;
+// Fifo trigger levels, in characters. A receive level of 0 would
+// keep the interrupt up with the fifo empty, so a quarter of a two
+// deep fifo is one character.
+wire [pRxFifoAddrWidth:0] rx_trig_lvl =
+	rx_trig==2'd0 ? (pRxFifoAddrWidth < 2 ? 1 : (1 << pRxFifoAddrWidth) / 4) :
+	rx_trig==2'd1 ? (1 << pRxFifoAddrWidth) / 2 :
+	rx_trig==2'd2 ? (1 << pRxFifoAddrWidth) * 3 / 4 :
+	(1 << pRxFifoAddrWidth);
+// most characters left in the transmitter fifo
+wire [pTxFifoAddrWidth:0] tx_trig_lvl =
+	tx_trig==2'd0 ? (1 << pTxFifoAddrWidth) * 3 / 4 :
+	tx_trig==2'd1 ? (1 << pTxFifoAddrWidth) / 2 :
+	tx_trig==2'd2 ? (1 << pTxFifoAddrWidth) / 4 :
+	0;
+
+wire rx_ready = fifo_trig ? rx_cnt >= rx_trig_lvl : data_present_o;
+wire tx_ready = fifo_trig ? tx_cnt <= tx_trig_lvl : tx_empty;
+
+wire rxIRQ = rx_ready & rx_present_ie;
+wire toIRQ = fifo_trig & rx_timeout & rx_present_ie;
+wire txIRQ = tx_ready & tx_empty_ie;
 wire msIRQ = dcd_chg & dcd_ie;
+wire dmaIRQ;
 
 assign irq_o = 
 	  rxIRQ
+	| toIRQ
 	| txIRQ
 	| msIRQ
+	| dmaIRQ
 	;
 
 wire [2:0] irqenc =
 	rxIRQ ? 1 :
+	toIRQ ? 2 :
 	txIRQ ? 3 :
 	msIRQ ? 4 :
+	dmaIRQ ? 5 :
 	0;
 
 wire [7:0] rx_do;
@@ -318,7 +520,7 @@ wire rxd_int;
 assign rxd_int = loopback ? txd_int : rxd_i;
 assign txd_o = loopback ? 1'b1 : txd_int;
 wire cts_nint;
-assign cts_nint = loopback ? data_present_o : cts_ni;
+assign cts_nint = loopback ? (autorts ? rts_no : rx_full) : cts_ni;
 /*
 wire rts_nint;
 wire cts_nint;
@@ -332,7 +534,7 @@ JO: How does this work "for real"?
 JO: dsr_ni
 */
 
-rtfSimpleUartRx uart_rx0(
+rtfSimpleUartRx #(.pFifoAddrWidth(pRxFifoAddrWidth)) uart_rx0(
 	.rst_i(rst_i),
 	.clk_i(clk_i),
 	.cyc_i(cyc_i),
@@ -341,17 +543,28 @@ rtfSimpleUartRx uart_rx0(
 	.we_i(we_i),
 	.dat_o(rx_do),
 	.baud16x_ce(baud16),
+	.dbits(ff[1:0]),
+	.parity_en(ff[3]),
+	.parity_even(ff[4]),
+	.majority(majority),
 	.clear(clear),
-	.rxd(rxd_int),
+	.rxd(rxd_int | ab_busy),
 	.data_present(data_present_o),
+	.full(rx_full),
+	.fifo_cnt(rx_cnt),
+	.timeout(rx_timeout),
+	.dma_own(dma_rx_own),
+	.dma_rd(dma_rx_rd),
+	.dma_dat(dma_rx_dat),
 	.frame_err(frame_err),
+	.parity_err(parity_err),
 	.overrun(over_run)
-        // JO: ack_o and baud8x are unconnected.
+        // JO: ack_o is unconnected.
         , .ack_o()
-        , .baud8x(1'b0)
+        , .baud8x(baud8x)
 );
 
-rtfSimpleUartTx uart_tx0(
+rtfSimpleUartTx #(.pFifoAddrWidth(pTxFifoAddrWidth)) uart_tx0(
 	.rst_i(rst_i),
 	.clk_i(clk_i),
 	.cyc_i(cyc_i),
@@ -360,58 +573,150 @@ rtfSimpleUartTx uart_tx0(
 	.we_i(we_i),
 	.dat_i(dat_i),
 	.baud16x_ce(baud16),
+	.dbits(ff[1:0]),
+	.parity_en(ff[3]),
+	.parity_even(ff[4]),
+	.stop2(ff[2]),
 	.cts(ctsx[1]|~hwfc),
 	.txd(txd_int),
-	.empty(tx_empty)
+	.empty(tx_empty),
+	.full(tx_full),
+	.fifo_cnt(tx_cnt),
+	.txc(tx_done),
+	.dma_own(dma_tx_own),
+	.dma_wr(dma_tx_wr),
+	.dma_dat(dma_tx_dat)
         // JO unconnected:
         , .ack_o()
-        , .baud8x(1'b0)
-        , .txc()
+        , .baud8x(baud8x)
 );
 
+// The dma engine, only with pDma set. Without it there is no dma
+// state at all, and the fifos and the master port see an idle engine.
+generate
+if (pDma) begin : dma
+	rtfSimpleUartDma uart_dma0(
+		.rst_i(rst_i),
+		.clk_i(clk_i),
+		.cs_i(dma_cs),
+		.we_i(we_i),
+		.adr_i(adr_i[2:0]),
+		.dat_i(dat_i),
+		.dat_o(dma_do),
+		.irq(dmaIRQ),
+		.m_cyc_o(m_cyc_o),
+		.m_stb_o(m_stb_o),
+		.m_we_o(m_we_o),
+		.m_adr_o(m_adr_o),
+		.m_dat_o(m_dat_o),
+		.m_dat_i(m_dat_i),
+		.m_ack_i(m_ack_i),
+		.tx_full(tx_full),
+		.tx_own(dma_tx_own),
+		.tx_wr(dma_tx_wr),
+		.tx_dat(dma_tx_dat),
+		.rx_empty(~data_present_o),
+		.rx_dat(dma_rx_dat),
+		.rx_own(dma_rx_own),
+		.rx_rd(dma_rx_rd)
+	);
+end
+else begin : no_dma
+	assign dma_do = 8'h00;
+	assign dmaIRQ = 1'b0;
+	assign dma_tx_own = 1'b0;
+	assign dma_tx_wr = 1'b0;
+	assign dma_tx_dat = 8'h00;
+	assign dma_rx_own = 1'b0;
+	assign dma_rx_rd = 1'b0;
+	assign m_cyc_o = 1'b0;
+	assign m_stb_o = 1'b0;
+	assign m_we_o = 1'b0;
+	assign m_adr_o = 32'h0;
+	assign m_dat_o = 8'h00;
+end
+endgenerate
+
 // mux the reg outputs
+reg [7:0] dat;
 always @*
 	if (cs) begin
 		case(adr_i[3:0])	// synopsys full_case parallel_case
-		`UART_LS:	dat_o <= {1'b0, tx_empty, tx_empty, 1'b0, frame_err, 1'b0, over_run, data_present_o};
-		`UART_MS:	dat_o <= {dcdx[1],1'b0,dsrx[1],ctsx[1],dcd_chg,3'b0};
-		`UART_IS:	dat_o <= {irq_o, 2'b0, irqenc, 2'b0};
-                `UART_IER:      dat_o <= {4'b0000, dcd_ie, 1'b0, tx_empty_ie, rx_present_ie};                
-                `UART_MC:       dat_o <= {3'b000, loopback, 2'b00, ~rts_no, ~dtr_no};
-                `UART_CTRL:     dat_o <= {7'b0000000, hwfc};
-                `UART_CLKM0:    dat_o <= 8'h00;
-                `UART_CLKM1:    dat_o <= ck_mul[7:0];
-                `UART_CLKM2:    dat_o <= ck_mul[15:8];
-                `UART_CLKM3:    dat_o <= ck_mul[23:16];
-                `UART_SPR:	dat_o <= spr;
-		default:	dat_o <= rx_do;
+		`UART_LS:	dat = {1'b0, tx_empty & tx_done, ~tx_full, 1'b0, frame_err, parity_err, over_run, data_present_o};
+		`UART_MS:	dat = {dcdx[1],1'b0,dsrx[1],ctsx[1],dcd_chg,3'b0};
+		`UART_IS:	dat = {irq_o, 2'b0, irqenc, 2'b0};
+                `UART_IER:      dat = {4'b0000, dcd_ie, 1'b0, tx_empty_ie, rx_present_ie};                
+                `UART_FF:       dat = {3'b000, ff};
+                `UART_MC:       dat = {3'b000, loopback, 2'b00, ~rts_n, ~dtr_no};
+                `UART_CTRL:     dat = {3'b000, autorts, ab_busy, majority, baud8x, hwfc};
+                `UART_CLKM0:    dat = ck_mul[7:0];
+                `UART_CLKM1:    dat = ck_mul[15:8];
+                `UART_CLKM2:    dat = ck_mul[23:16];
+                `UART_CLKM3:    dat = ck_mul[31:24];
+                `UART_FC:       dat = {3'b000, tx_trig, rx_trig, fifo_trig};
+                `UART_RTSW:     dat = {rts_lo, rts_hi};
+                `UART_SPR:	dat = spr;
+		default:	dat = rx_do;
 		endcase
 	end
+	else if (dma_cs)
+		dat = dma_do;
 	else
-		dat_o <= 8'b0;
+		dat = 8'b0;
 
-// Note: baud clock should pulse high for only a single
-// cycle!
+// In pipelined mode the read data is registered along with
+// the acknowledge.
+reg [7:0] dat_r;
 always @(posedge clk_i)
-	if (rst_i)
-		c <= 0;
-	else
-		c <= c + ck_mul;
+	dat_r <= dat;
+
+assign dat_o = pPipelined ? dat_r : dat;
 
-// for detecting an edge on the msb
-edge_det ed0(.rst(rst_i), .clk(clk_i), .ce(1'b1), .i(c[23]), .pe(baud16), .ne(), .ee() );
+// Baud rate generator. With pAbstractBaud set, the 16x clock
+// enable is driven by baud16_i instead (verification only).
+rtfSimpleUartBaud #(.pWidth(pBaudWidth), .pAbstract(pAbstractBaud)) baud0
+(
+	.rst_i(rst_i),
+	.clk_i(clk_i),
+	.ck_mul(ck_mul),
+	.tick_i(baud16_i),
+	.baud16(baud16)
+);
    
+// Autobaud, armed and disarmed by CTRL bit 3
+rtfSimpleUartAutobaud ab0
+(
+	.rst_i(rst_i),
+	.clk_i(clk_i),
+	.start(cs && we_i && adr_i[3:0]==`UART_CTRL && dat_i[3]),
+	.cancel(cs && we_i && adr_i[3:0]==`UART_CTRL && !dat_i[3]),
+	.baud8x(baud8x),
+	.rxd(rxd_int),
+	.busy(ab_busy),
+	.ld(ab_ld),
+	.ck_mul(ab_ck_mul)
+);
+
 // register updates
 always @(posedge clk_i) begin
 	if (rst_i) begin
-		rts_no <= ~pRts;
+		rts_n <= ~pRts;
 		rx_present_ie <= 1'b0;
 		tx_empty_ie <= 1'b0;
 		dcd_ie <= 1'b0;
 		hwfc <= 1'b1;
+		baud8x <= 1'b0;
+		majority <= 1'b0;
+		autorts <= 1'b0;
+		rts_hi <= 4'd12;
+		rts_lo <= 4'd4;
+		ff <= 5'h03;
 		dtr_no <= ~pDtr;
                 loopback <= 1'b0;
 		ck_mul <= pClkMul;
+		fifo_trig <= 1'b0;
+		rx_trig <= 2'b00;
+		tx_trig <= 2'b00;
            	spr <= 8'h00;
 	end
 	else if (cs & we_i) begin
@@ -422,24 +727,62 @@ always @(posedge clk_i) begin
 				tx_empty_ie <= dat_i[1];
 				dcd_ie <= dat_i[3];
 				end
+		`UART_FF:	ff <= dat_i[4:0];
 		`UART_MC:
 				begin
 				dtr_no <= ~dat_i[0];
-				rts_no <= ~dat_i[1];
+				rts_n <= ~dat_i[1];
                                 loopback <= dat_i[4];
 				end
-		`UART_CTRL:	hwfc <= dat_i[0];
-		`UART_CLKM1:	ck_mul[7:0] <= dat_i;
-		`UART_CLKM2:	ck_mul[15:8] <= dat_i;
-		`UART_CLKM3:	ck_mul[23:16] <= dat_i;
+		`UART_CTRL:
+				begin
+				hwfc <= dat_i[0];
+				baud8x <= dat_i[1];
+				majority <= dat_i[2];
+				autorts <= dat_i[4];
+				end
+		`UART_CLKM0:	ck_mul[7:0] <= dat_i;
+		`UART_CLKM1:	ck_mul[15:8] <= dat_i;
+		`UART_CLKM2:	ck_mul[23:16] <= dat_i;
+		`UART_CLKM3:	ck_mul[31:24] <= dat_i;
+		`UART_FC:
+				begin
+				fifo_trig <= dat_i[0];
+				rx_trig <= dat_i[2:1];
+				tx_trig <= dat_i[4:3];
+				end
+		`UART_RTSW:
+				begin
+				rts_hi <= dat_i[3:0];
+				rts_lo <= dat_i[7:4];
+				end
                 `UART_SPR:	spr <= dat_i;
 		default:
 			;
 		endcase
 	end    
+	// a measured multiplier wins over a write in the same cycle
+	if (!rst_i && ab_ld)
+		ck_mul <= ab_ck_mul;
 end
 
 
+// Automatic rts, with hysteresis between the watermarks. The fifo
+// level and the marks are compared in sixteenths of the depth.
+wire [pRxFifoAddrWidth+4:0] rx_lvl16 = {rx_cnt, 4'h0};
+wire [pRxFifoAddrWidth+4:0] rts_hi16 = {1'b0, rts_hi, {pRxFifoAddrWidth{1'b0}}};
+wire [pRxFifoAddrWidth+4:0] rts_lo16 = {1'b0, rts_lo, {pRxFifoAddrWidth{1'b0}}};
+
+always @(posedge clk_i)
+	if (rst_i)
+		rts_off <= 1'b0;
+	else if (rx_lvl16 >= rts_hi16)
+		rts_off <= 1'b1;
+	else if (rx_lvl16 <= rts_lo16)
+		rts_off <= 1'b0;
+
+assign rts_no = rts_n | (autorts & rts_off);
+
 // synchronize external signals
 always @(posedge clk_i)
 	ctsx <= {ctsx[0],~cts_nint};
@@ -450,5 +793,23 @@ always @(posedge clk_i)
 always @(posedge clk_i)
 	dsrx <= {dsrx[0],~dsr_ni};
 
+`ifdef FORMAL
+// Invariants, proved by k-induction (make prove_spr)
+
+// The scratchpad takes the value written to it, and keeps it until
+// the next write, so a read gives back the last value written
+reg f_ok, f_spr_wr;
+reg [7:0] f_spr_dat;
+reg [7:0] f_spr;
+always @(posedge clk_i) begin
+	f_ok <= !rst_i;
+	f_spr_wr <= !rst_i && cs && we_i && adr_i[3:0] == `UART_SPR;
+	f_spr_dat <= dat_i;
+	f_spr <= spr;
+end
+spr_write: assert property (f_spr_wr |-> spr == f_spr_dat);
+spr_hold: assert property (f_ok && !f_spr_wr |-> spr == f_spr);
+`endif
+
 endmodule
 
@@ -0,0 +1,161 @@
+// ============================================================================
+//	(C) 2011,2013  Robert Finch
+//  All rights reserved.
+//	robfinch@<remove>finitron.ca
+//
+//	rtfSimpleUartAutobaud.v
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the <organization> nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//	Autobaud for rtfSimpleUart. Once armed, it times a sync character
+//	on the serial input and works out the clock multiplier that
+//	gives the baud rate it was sent at.
+//
+//	The sync character has to be 0x55 ('U'), 8 data bits: its
+//	falling edges are at the start bit and at data bits 1, 3, 5 and
+//	7, so the first to the fifth of them is eight bit times. Timing
+//	eight bits rather than one keeps the error of the measurement
+//	(a clock or so) to a fraction of a percent. With span the clocks
+//	counted, the multiplier is
+//
+//		16 * 2^32 / (span / 8) = 2^39 / span
+//
+//	(2^38 / span in 8x mode), worked out a bit per clock by a
+//	restoring divider and rounded to the nearest. The generator ticks
+//	on the rising edge of its accumulator's top bit, so a tick every
+//	other clock (2^31) is the most a multiplier can give: a span
+//	shorter than that, 256 clocks (128 in 8x mode), is taken as the
+//	shortest one that fits.
+//
+//	The multiplier is handed out with ld once it's ready, and busy
+//	is set from arming until the end of the sync character, one and
+//	a half bit times after its fifth falling edge, or until the
+//	divider is done if that takes longer. The uart keeps the
+//	receiver away from the line in the meantime, so the sync
+//	character doesn't end up in the fifo.
+//
+//	Any other character on the line while armed gives a wrong rate;
+//	the peer is expected to send the 'U' on its own, and wait for the
+//	firmware to answer before sending anything else.
+//============================================================================
+
+`define AB_IDLE		2'd0
+`define AB_ARMED	2'd1	// waiting for the start bit
+`define AB_MEASURE	2'd2	// timing the next four falling edges
+`define AB_DIVIDE	2'd3	// working out the multiplier
+
+module rtfSimpleUartAutobaud(
+	input rst_i,			// reset
+	input clk_i,			// clock
+	input start,			// arm, one cycle
+	input cancel,			// disarm, one cycle
+	input baud8x,			// 8x oversampling
+	input rxd,				// serial input
+	output busy,			// armed, or the sync character is still going
+	output reg ld,			// ck_mul is ready, one cycle
+	output [31:0] ck_mul	// measured clock multiplier
+);
+
+reg [1:0] state;
+reg [2:0] rxdd;			// rxd synchronizer
+reg [23:0] span;		// clocks since the start bit
+reg [1:0] edges;		// falling edges since the start bit
+reg [23:0] skip;		// clocks to the end of the sync character
+reg [23:0] r;			// divider remainder
+reg [32:0] q;			// quotient, with a bit more for rounding
+reg [5:0] n;			// quotient bits to go
+
+wire fall = rxdd[2] & ~rxdd[1];
+wire [23:0] span_min = baud8x ? 24'd128 : 24'd256;
+wire [24:0] r2 = {r,1'b0};
+wire [33:0] qr = q + 34'd1;
+
+assign ck_mul = qr[32:1];
+assign busy = state != `AB_IDLE || skip != 24'd0;
+
+always @(posedge clk_i)
+	rxdd <= {rxdd[1:0],rxd};
+
+always @(posedge clk_i)
+	if (rst_i) begin
+		state <= `AB_IDLE;
+		skip <= 24'd0;
+		ld <= 1'b0;
+	end
+	else begin
+		ld <= 1'b0;
+		if (skip != 24'd0)
+			skip <= skip - 24'd1;
+		if (cancel) begin
+			state <= `AB_IDLE;
+			skip <= 24'd0;
+		end
+		else if (start)
+			state <= `AB_ARMED;
+		else
+			case (state)
+			`AB_ARMED:
+				if (fall) begin
+					span <= 24'd1;
+					edges <= 2'd0;
+					state <= `AB_MEASURE;
+				end
+			`AB_MEASURE:
+				if (fall && edges == 2'd3) begin
+					// the sync character has one and a half bits to go
+					skip <= (span >> 3) + (span >> 4);
+					if (span < span_min)
+						span <= span_min;
+					r <= 24'd1;
+					q <= 33'd0;
+					n <= baud8x ? 6'd39 : 6'd40;
+					state <= `AB_DIVIDE;
+				end
+				else begin
+					if (fall)
+						edges <= edges + 2'd1;
+					if (span != 24'hFFFFFF)
+						span <= span + 24'd1;
+				end
+			`AB_DIVIDE:
+				if (n != 6'd0) begin
+					if (r2 >= {1'b0,span}) begin
+						r <= r2[23:0] - span;	// less than span, fits
+						q <= {q[31:0],1'b1};
+					end
+					else begin
+						r <= r2[23:0];
+						q <= {q[31:0],1'b0};
+					end
+					n <= n - 6'd1;
+				end
+				else begin
+					ld <= 1'b1;
+					state <= `AB_IDLE;
+				end
+			default:
+				;
+			endcase
+	end
+
+endmodule
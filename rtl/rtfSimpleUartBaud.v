@@ -0,0 +1,75 @@
+// ============================================================================
+//	(C) 2011,2013  Robert Finch
+//  All rights reserved.
+//	robfinch@<remove>finitron.ca
+//
+//	rtfSimpleUartBaud.v
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the <organization> nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//	16x baud rate clock enable for rtfSimpleUart.
+//
+//	The clock multiplier is added to a pWidth bit accumulator on
+//	every clock, and the 16x clock enable pulses for one cycle on
+//	every rising edge of the accumulator msb (harmonic frequency
+//	synthesizer). The multiplier is always 32 bits, a narrower
+//	accumulator takes its upper pWidth bits and ignores the rest,
+//	eg. pWidth = 24 leaves out CM0. Over a long run the tick rate is
+//	clk_i * ck_mul / 2^32 (to within the dropped bits), and a single
+//	tick is never more than one clock early or late.
+//
+//	With pAbstract set, the accumulator is left out and the clock
+//	enable is taken straight from tick_i. This is for verification
+//	only: a harness can then drive the ticks nondeterministically.
+//	Any multiplier in the range 2^32/K .. 2^31 gives at least one
+//	tick in every K clocks, so a harness that allows every tick
+//	pattern with that property (see WB_ABSTRACT_BAUD in wishbone.h)
+//	covers all of those multipliers at once. The baud_refine harness
+//	checks the property for the accumulator.
+//============================================================================
+
+module rtfSimpleUartBaud #(parameter pWidth = 32, parameter pAbstract = 0) (
+	input rst_i,			// reset
+	input clk_i,			// clock
+	input [31:0] ck_mul,	// clock multiplier
+	input tick_i,			// abstract 16x baud clock enable (pAbstract = 1)
+	output baud16			// 16x baud clock enable (active one cycle only!)
+);
+
+reg [pWidth-1:0] c;	// current count
+wire pe;
+
+// Note: baud clock should pulse high for only a single
+// cycle!
+always @(posedge clk_i)
+	if (rst_i)
+		c <= 0;
+	else
+		c <= c + ck_mul[31:32-pWidth];
+
+// for detecting an edge on the msb
+edge_det ed0(.rst(rst_i), .clk(clk_i), .ce(1'b1), .i(c[pWidth-1]), .pe(pe), .ne(), .ee() );
+
+assign baud16 = pAbstract ? tick_i : pe;
+
+endmodule
@@ -0,0 +1,243 @@
+// ============================================================================
+//	(C) 2011,2013  Robert Finch
+//  All rights reserved.
+//	robfinch@<remove>finitron.ca
+//
+//	rtfSimpleUartDma.v
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the <organization> nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//	Simple dma engine for rtfSimpleUart. It moves a buffer between
+//	memory and the uart fifos through a WISHBONE master port, one
+//	byte per bus cycle, so the cpu doesn't have to touch the
+//	transmit / receive buffer at all.
+//
+//	Register Description (offset from the dma register window)
+//
+//	0-3	AD0-AD3	- memory address (RW)
+//		AD0 is the least significant byte. Reads return the
+//		address of the next byte to be transferred.
+//
+//	4-5	LN0-LN1	- length (RW)
+//		number of bytes to transfer, LN0 is the least
+//		significant byte. Reads return the number of bytes
+//		still to be transferred.
+//
+//	6	CTL	- control register (RW)
+//		bit 0 = direction, 0 = memory to transmitter,
+//				1 = receiver to memory
+//		bit 1 = interrupt when the transfer is complete
+//		bit 7 = writing a one starts the transfer, and clears the
+//				done bit of the last one. Reads as one while the
+//				transfer is in progress.
+//
+//	7	ST	- status register (RW)
+//		bit 0 = done, set when a transfer completes. Writing to
+//				the status register clears it.
+//
+//	The address and length registers shouldn't be written while
+//	a transfer is in progress. The fifo the transfer uses belongs to
+//	the dma until it is done: cpu writes to the transmit buffer
+//	(memory to transmitter) are dropped, and cpu reads of the
+//	receive buffer (receiver to memory) return 0 and leave the fifo
+//	alone, so a byte is never lost or taken twice.
+//
+//   	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|WISHBONE Datasheet
+//	|WISHBONE SoC Architecture Specification, Revision B.3
+//	|
+//	|Description:						Specifications:
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|General Description:				uart dma master
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|Supported Cycles:					MASTER,READ/WRITE
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|Data port, size:					8 bit
+//	|Data port, granularity:			8 bit
+//	|Data port, maximum operand size:	8 bit
+//	|Data transfer ordering:			Undefined
+//	|Data transfer sequencing:			Undefined
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|Clock frequency constraints:		none
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|Supported signal list and			Signal Name		WISHBONE equiv.
+//	|cross reference to equivalent		m_ack_i			ACK_I
+//	|WISHBONE signals					m_adr_o[31:0]	ADR_O()
+//	|									clk_i			CLK_I
+//	|                                   rst_i           RST_I()
+//	|									m_dat_i(7:0)	DAT_I()
+//	|									m_dat_o(7:0)	DAT_O()
+//	|									m_cyc_o			CYC_O
+//	|									m_stb_o			STB_O
+//	|									m_we_o			WE_O
+//	|
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//	|Special requirements:
+//	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//============================================================================
+
+`define DMA_IDLE	2'd0
+`define DMA_RD		2'd1	// reading memory, for the transmitter
+`define DMA_WR		2'd2	// writing memory, from the receiver
+
+module rtfSimpleUartDma(
+	input rst_i,			// reset
+	input clk_i,			// clock
+	// register interface
+	input cs_i,				// dma registers selected
+	input we_i,				// 1 = write
+	input [2:0] adr_i,		// register address
+	input [7:0] dat_i,		// data in
+	output reg [7:0] dat_o,	// data out
+	output irq,				// transfer complete interrupt
+	// WISHBONE master interface
+	output reg m_cyc_o,		// cycle valid
+	output reg m_stb_o,		// strobe
+	output reg m_we_o,		// 1 = write
+	output [31:0] m_adr_o,	// memory address
+	output reg [7:0] m_dat_o,	// data to memory
+	input [7:0] m_dat_i,	// data from memory
+	input m_ack_i,			// transfer acknowledge
+	// transmitter fifo
+	input tx_full,			// transmitter fifo full
+	output tx_own,			// the transfer owns the transmitter fifo
+	output tx_wr,			// write to transmitter fifo
+	output [7:0] tx_dat,	// transmitter fifo data
+	// receiver fifo
+	input rx_empty,			// receiver fifo empty
+	input [7:0] rx_dat,		// oldest character in receiver fifo
+	output rx_own,			// the transfer owns the receiver fifo
+	output rx_rd			// remove a character from receiver fifo
+);
+
+reg [1:0] state;
+reg [31:0] adr;		// memory address
+reg [15:0] len;		// bytes left
+reg dir;			// 0 = memory to transmitter, 1 = receiver to memory
+reg ie;				// interrupt on completion
+reg busy;			// transfer in progress
+reg done;			// transfer complete
+
+assign m_adr_o = adr;
+assign irq = done & ie;
+
+// A byte read from memory goes straight into the transmitter
+// fifo, a byte written to memory is removed from the receiver
+// fifo, both on the acknowledge.
+assign tx_own = busy & ~dir;
+assign rx_own = busy & dir;
+assign tx_wr = state==`DMA_RD && m_ack_i;
+assign tx_dat = m_dat_i;
+assign rx_rd = state==`DMA_WR && m_ack_i;
+
+always @*
+	case(adr_i)
+	3'd0:	dat_o = adr[7:0];
+	3'd1:	dat_o = adr[15:8];
+	3'd2:	dat_o = adr[23:16];
+	3'd3:	dat_o = adr[31:24];
+	3'd4:	dat_o = len[7:0];
+	3'd5:	dat_o = len[15:8];
+	3'd6:	dat_o = {busy, 5'b0, ie, dir};
+	default:	dat_o = {7'b0, done};
+	endcase
+
+always @(posedge clk_i)
+	if (rst_i) begin
+		state <= `DMA_IDLE;
+		m_cyc_o <= 1'b0;
+		m_stb_o <= 1'b0;
+		m_we_o <= 1'b0;
+		adr <= 32'd0;
+		len <= 16'd0;
+		dir <= 1'b0;
+		ie <= 1'b0;
+		busy <= 1'b0;
+		done <= 1'b0;
+	end
+	else begin
+
+		if (cs_i & we_i) begin
+			case (adr_i)
+			3'd0:	adr[7:0] <= dat_i;
+			3'd1:	adr[15:8] <= dat_i;
+			3'd2:	adr[23:16] <= dat_i;
+			3'd3:	adr[31:24] <= dat_i;
+			3'd4:	len[7:0] <= dat_i;
+			3'd5:	len[15:8] <= dat_i;
+			3'd6:
+				begin
+				dir <= dat_i[0];
+				ie <= dat_i[1];
+				if (dat_i[7]) begin
+					busy <= 1'b1;
+					done <= 1'b0;
+				end
+				end
+			3'd7:	done <= 1'b0;
+			endcase
+		end
+
+		case (state)
+
+		// Start a bus cycle as soon as the fifo can take / has
+		// another byte.
+		`DMA_IDLE:
+			if (busy) begin
+				if (len==16'd0) begin
+					busy <= 1'b0;
+					done <= 1'b1;
+				end
+				else if (!dir && !tx_full) begin
+					m_cyc_o <= 1'b1;
+					m_stb_o <= 1'b1;
+					m_we_o <= 1'b0;
+					state <= `DMA_RD;
+				end
+				else if (dir && !rx_empty) begin
+					m_cyc_o <= 1'b1;
+					m_stb_o <= 1'b1;
+					m_we_o <= 1'b1;
+					m_dat_o <= rx_dat;
+					state <= `DMA_WR;
+				end
+			end
+
+		`DMA_RD,`DMA_WR:
+			if (m_ack_i) begin
+				m_cyc_o <= 1'b0;
+				m_stb_o <= 1'b0;
+				m_we_o <= 1'b0;
+				adr <= adr + 32'd1;
+				len <= len - 16'd1;
+				state <= `DMA_IDLE;
+			end
+
+		default:
+			state <= `DMA_IDLE;
+
+		endcase
+	end
+
+endmodule
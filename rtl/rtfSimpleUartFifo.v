@@ -0,0 +1,102 @@
+// ============================================================================
+//	(C) 2011,2013  Robert Finch
+//  All rights reserved.
+//	robfinch@<remove>finitron.ca
+//
+//	rtfSimpleUartFifo.v
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the <organization> nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//	Small synchronous fifo shared by the receiver and the transmitter.
+//
+//	The depth is 2**pAddrWidth entries. The read and write pointers
+//	carry one extra bit so that a full fifo can be told apart from an
+//	empty one without a separate counter; the fill level is simply
+//	the difference of the two pointers.
+//
+//	The oldest entry is always presented on dout (first word fall
+//	through), so a read strobe both returns and removes it in the
+//	same clock cycle.
+//
+//	Writes to a full fifo and reads from an empty fifo are ignored.
+//============================================================================
+
+module rtfSimpleUartFifo #(parameter pAddrWidth = 4) (
+	input rst,			// reset
+	input clk,			// clock
+	input clear,		// discard the contents
+	input wr,			// write din
+	input [7:0] din,	// data in
+	input rd,			// remove the oldest entry
+	output [7:0] dout,	// oldest entry
+	output [pAddrWidth:0] cnt,	// number of entries
+	output empty,		// fifo is empty
+	output full			// fifo is full
+);
+
+reg [7:0] mem [0:(1<<pAddrWidth)-1];
+reg [pAddrWidth:0] wp;	// write pointer
+reg [pAddrWidth:0] rp;	// read pointer
+
+wire push = wr & ~full;
+wire pop = rd & ~empty;
+
+assign cnt = wp - rp;
+assign empty = wp == rp;
+assign full = cnt[pAddrWidth];
+assign dout = mem[rp[pAddrWidth-1:0]];
+
+always @(posedge clk)
+	if (push) mem[wp[pAddrWidth-1:0]] <= din;
+
+always @(posedge clk)
+	if (rst | clear) begin
+		wp <= 0;
+		rp <= 0;
+	end
+	else begin
+		if (push) wp <= wp + 1'b1;
+		if (pop) rp <= rp + 1'b1;
+	end
+
+`ifdef FORMAL
+// Invariants, proved by k-induction (make prove_fifo)
+fifo_cnt_range: assert property (cnt <= (1 << pAddrWidth));
+
+// Every push adds one entry and every pop takes one away, and a
+// character pushed into an empty fifo is the next one out
+reg f_ok, f_push, f_pop;
+reg [pAddrWidth:0] f_cnt;
+reg [7:0] f_din;
+always @(posedge clk) begin
+	f_ok <= !rst && !clear;
+	f_push <= push;
+	f_pop <= pop;
+	f_cnt <= cnt;
+	f_din <= din;
+end
+fifo_count: assert property (f_ok |-> cnt == f_cnt + f_push - f_pop);
+fifo_first: assert property (f_ok && f_push && f_cnt == 0 |-> dout == f_din);
+`endif
+
+endmodule
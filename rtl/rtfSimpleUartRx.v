@@ -30,11 +30,15 @@
 //	Simple UART receiver core
 //		Features:
 //			false start bit detection
-//			framing error detection
+//			optional majority sampling, rejects one clock glitches
+//			framing and parity error detection
 //			overrun state detection
+//			receive fifo (2**pFifoAddrWidth characters deep)
+//			character timeout detection
 //			resynchronization on every character
-//			fixed format 1 start - 8 data - 1 stop bits
-//			uses 16x clock rate
+//			1 start - 5 to 8 data - optional parity - 1 or 2 stop bits
+//			(only the first stop bit is checked)
+//			uses 16x clock rate, or 8x (baud8x)
 //			
 //		This core may be used as a standalone peripheral
 //	on a SoC bus if all that is desired is recieve
@@ -80,7 +84,10 @@
 `define IDLE	0
 `define CNT		1
 
-module rtfSimpleUartRx(
+module rtfSimpleUartRx #(
+	parameter pFifoAddrWidth = 4	// receive fifo holds 2**pFifoAddrWidth characters
+)
+(
 	// WISHBONE SoC bus interface
 	input rst_i,			// reset
 	input clk_i,			// clock
@@ -93,23 +100,37 @@ module rtfSimpleUartRx(
 	input cs_i,				// chip select
 	input baud16x_ce,		// baud rate clock enable
     input tri0 baud8x,       // switches to mode baudX8
+	input [1:0] dbits,		// data bits - 5
+	input parity_en,		// parity bit enable
+	input parity_even,		// 1 = even parity, 0 = odd
+	input majority,			// majority sampling
 	input clear,			// clear reciever
 	input rxd,				// external serial input
-	output reg data_present,	// data present in fifo
+	output data_present,	// data present in fifo
+	output full,			// fifo is full
+	output [pFifoAddrWidth:0] fifo_cnt,	// number of characters in fifo
+	output timeout,			// character timeout
+	input dma_own,			// the dma owns the fifo, cpu reads are refused
+	input dma_rd,			// dma removes a character from the fifo
+	output [7:0] dma_dat,	// oldest character in the fifo, for the dma
 	output reg frame_err,		// framing error
+	output reg parity_err,		// parity error
 	output reg overrun			// receiver overrun
 );
 
-//0 - simple sampling at middle of symbol period
-//>0 - sampling of 3 middle ticks of sumbol perion and results as majority
+//0 - simple sampling at middle of symbol period, or majority
+//    sampling when the majority input is set
+//>0 - majority sampling always
 parameter SamplerStyle = 0;
+parameter pTimeout = 640;		// character timeout in baud16x ticks (four characters), half of that in 8x mode
 
 // variables
 reg [7:0] cnt;			// sample bit rate counter
-reg [9:0] rx_data;		// working receive data register
+reg [11:0] rx_data;		// working receive data register
 reg state;				// state machine
 reg wf;					// buffer write
-reg [7:0] dat;
+wire [7:0] dat;			// oldest character in the fifo
+wire empty;
 
 wire isX8;
 
@@ -119,46 +140,103 @@ assign isX8 = baud8x;
 
 reg modeX8;
 
+// The format, taken between characters like the mode
+reg [1:0] fdbits;
+reg fpen;
+reg feven;
+wire [3:0] nd = 4'd5 + fdbits;
+
+// Once the frame is in, the stop bit is in rx_data[11], the parity
+// bit, if there is one, below it, and the data bits below that.
+wire [7:0] rx_char = (rx_data >> (4'd11 - fpen - nd)) & (8'hFF >> ~fdbits);
+// The parity is checked as the stop bit is sampled, one shift
+// earlier: the parity bit and the data bits are the top nd + 1 bits.
+wire rx_par = ^(rx_data & (12'hFFF << (4'd11 - nd))) ^ ~feven;
+
 assign ack_o = cyc_i & stb_i & cs_i;
-assign dat_o = ack_o ? dat : 8'b0;
+wire cpu_rd = ack_o & ~we_i & ~dma_own;
+assign dat_o = (cpu_rd & ~empty) ? dat : 8'b0;
 
-// update data register
-always @(posedge clk_i)
-	if (wf) dat <= rx_data[8:1];
+// The receiver writes each character into the fifo, a read
+// removes the oldest one. Data is present as long as the fifo
+// is not empty.
+rtfSimpleUartFifo #(.pAddrWidth(pFifoAddrWidth)) fifo0
+(
+	.rst(rst_i),
+	.clk(clk_i),
+	.clear(clear),
+	.wr(wf),
+	.din(rx_char),
+	.rd(cpu_rd | dma_rd),
+	.dout(dat),
+	.cnt(fifo_cnt),
+	.empty(empty),
+	.full(full)
+);
 
-// on a read clear the data present status
-// but set the status when the data register
-// is updated by the receiver		
+assign data_present = ~empty;
+assign dma_dat = dat;
+
+// Character timeout
+// Count baud ticks while there are characters waiting in the
+// fifo but none is being received or read. The count starts
+// over with every character written to or read from the fifo.
+// A tick counts double in 8x mode, so the timeout stays at four
+// characters.
+reg [9:0] tocnt;
 always @(posedge clk_i)
-    if (rst_i)
-        data_present <= 0;
-    else if (wf) 
-        data_present <= 1;
-	else if (ack_o & ~we_i) data_present <= 0;
+	if (rst_i | clear | empty | wf | cpu_rd | dma_rd)
+		tocnt <= 0;
+	else if (baud16x_ce && !timeout)
+		tocnt <= tocnt + 1 + modeX8;
+
+assign timeout = tocnt >= pTimeout;
 
 
 // Three stage synchronizer to synchronize incoming data to
 // the local clock (avoids metastability).
+// For majority sampling the line is taken as two out of the three
+// stages after it, one clock later. A glitch of a single clock is
+// then never seen, neither in a sample nor as a start edge, as long
+// as there is at most one in any three clocks; around a real edge
+// it moves the edge by a clock at most.
 reg [5:0] rxdd          /* synthesis ramstyle = "logic" */; // synchronizer flops
-reg rxdsmp;             // majority samples
-reg rdxstart;           // for majority style sample solid 3tik-wide sample
-reg [1:0] rxdsum;
+reg rxdsmp;             // the line, sampled (majority)
+reg rdxstart;           // start edge
+reg rxdmaj_d;
+wire maj_en = majority || SamplerStyle > 0;
+wire rxdmaj = (rxdd[3] & rxdd[4]) | (rxdd[3] & rxdd[5]) | (rxdd[4] & rxdd[5]);
 always @(posedge clk_i) begin
 	rxdd <= {rxdd[4:0],rxd};
-    if (SamplerStyle == 0) begin
+	rxdmaj_d <= rxdmaj;
+    if (!maj_en) begin
         rxdsmp <= rxdd[3];
         rdxstart <= rxdd[4]&~rxdd[3];
     end
     else begin
-        rxdsum[1] <= rxdsum[0];
-        rxdsum[0] <= {1'b0,rxdd[3]} + {1'b0,rxdd[4]} + {1'b0,rxdd[5]};
-        rxdsmp <= rxdsum[1];
-        rdxstart <= (rxdsum[1] == 2'b00) & ((rxdsum[1] == 2'b11));
+        rxdsmp <= rxdmaj;
+        rdxstart <= rxdmaj_d & ~rxdmaj;
     end
 end
 
-`define CNT_FRAME  (8'h97)
-`define CNT_FINISH (8'h9D)
+// The start edge is only one clock wide, but the baud ticks are
+// usually further apart, so it is held until the next tick.
+reg start_pend;
+always @(posedge clk_i)
+	if (rst_i)
+		start_pend <= 1'b0;
+	else if (rdxstart)
+		start_pend <= 1'b1;
+	else if (baud16x_ce)
+		start_pend <= 1'b0;
+
+// The bit counter runs in 16 steps per bit and the line is sampled
+// in the middle of each bit, when cnt[3:0] is 7: 8 ticks after the
+// start edge for the start bit, 16 ticks apart after that, and the
+// (first) stop bit at CNT_FRAME. In 8x mode it starts at 1 and
+// counts in twos, so the same samples are 4 ticks after the edge
+// and 8 ticks apart.
+`define CNT_FRAME  ({nd + fpen + 4'd1, 4'h7})
 
 always @(posedge clk_i) begin
 	if (rst_i) begin
@@ -166,6 +244,7 @@ always @(posedge clk_i) begin
 		wf <= 1'b0;
 		overrun <= 1'b0;
         frame_err <= 1'b0;
+		parity_err <= 1'b0;
 	end
 	else begin
 
@@ -177,6 +256,7 @@ always @(posedge clk_i) begin
 			state <= `IDLE;
 			overrun <= 1'b0;
             frame_err <= 1'b0;
+			parity_err <= 1'b0;
 		end
 
 		else if (baud16x_ce) begin
@@ -187,19 +267,21 @@ always @(posedge clk_i) begin
 			// detected.
 			`IDLE:
 				// look for start bit
-				if (rdxstart)
+				if (rdxstart | start_pend)
 					state <= `CNT;
 
 			`CNT:
 				begin
 					// End of the frame ?
 					// - check for framing error
-					// - write data to read buffer
+					// - write data to the fifo, unless it is
+					//   full, in which case the character is lost
 					if (cnt==`CNT_FRAME)
 						begin	
 							frame_err <= ~rxdsmp;
-                            overrun <= data_present;
-							if (!data_present)
+							parity_err <= fpen & rx_par;
+                            overrun <= full;
+							if (!full)
 								wf <= 1'b1;
                             state <= `IDLE;
 						end
@@ -216,7 +298,7 @@ always @(posedge clk_i) begin
 						state <= `IDLE;
 
 					if (cnt[3:0]==4'h7)
-						rx_data <= {rxdsmp,rx_data[9:1]};
+						rx_data <= {rxdsmp,rx_data[11:1]};
 				end
 
 			endcase
@@ -229,8 +311,11 @@ end
 always @(posedge clk_i)
 	if (baud16x_ce) begin
 		if (state == `IDLE) begin
-			cnt <= modeX8;
+			cnt <= isX8;
             modeX8 <= isX8;
+			fdbits <= dbits;
+			fpen <= parity_en;
+			feven <= parity_even;
         end
         else begin
             cnt[7:1] <= cnt[7:1] + cnt[0];
@@ -238,5 +323,36 @@ always @(posedge clk_i)
         end
 	end
 
+`ifdef FORMAL
+// Invariants, proved by k-induction (make prove_rx)
+
+// A character is written only when the fifo has room for it
+rx_wf_idle: assert property (wf |-> state == `IDLE);
+rx_wf_room: assert property (wf |-> !full);
+
+// At the end of every frame the character is either written to
+// the fifo or reported as an overrun, never both
+reg f_frame_end;
+always @(posedge clk_i)
+	f_frame_end <= !rst_i && !clear && baud16x_ce && state == `CNT && cnt == `CNT_FRAME;
+rx_overrun: assert property (f_frame_end |-> overrun == !wf);
+
+// Across a read: it takes one character, so data present goes away
+// only with the last one, and it leaves the overrun flag alone, which
+// only changes at the end of a frame
+reg f_ok, f_rd, f_wf, f_overrun;
+reg [pFifoAddrWidth:0] f_cnt;
+always @(posedge clk_i) begin
+	f_ok <= !rst_i && !clear;
+	f_rd <= cpu_rd | dma_rd;
+	f_wf <= wf;
+	f_cnt <= fifo_cnt;
+	f_overrun <= overrun;
+end
+rx_read_last: assert property (f_ok && f_rd && !f_wf && f_cnt == 1 |-> !data_present);
+rx_read_more: assert property (f_ok && f_rd && f_cnt > 1 |-> data_present);
+rx_read_overrun: assert property (f_ok && !f_frame_end |-> overrun == f_overrun);
+`endif
+
 endmodule
 
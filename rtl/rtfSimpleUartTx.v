@@ -29,7 +29,9 @@
 //
 //		Simple uart transmitter core.
 //		Features:
-//			Fixed format 1 start - 8 data - 1 stop bits
+//			1 start - 5 to 8 data - optional parity - 1 or 2 stop bits
+//			transmit fifo (2**pFifoAddrWidth characters deep)
+//			16x or 8x baud rate clock (baud8x)
 //
 //
 //   	+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -71,7 +73,10 @@
 //	30 LUTs / 23 slices / 165MHz
 //============================================================================ */
 
-module rtfSimpleUartTx(
+module rtfSimpleUartTx #(
+	parameter pFifoAddrWidth = 4	// transmit fifo holds 2**pFifoAddrWidth characters
+)
+(
 	// WISHBONE SoC bus interface
 	input rst_i,		// reset
 	input clk_i,		// clock
@@ -84,15 +89,25 @@ module rtfSimpleUartTx(
 	input cs_i,			// chip select
 	input baud16x_ce,	// baud rate clock enable
     input tri0 baud8x,       // switches to mode baudX8
+	input [1:0] dbits,	// data bits - 5
+	input parity_en,	// parity bit enable
+	input parity_even,	// 1 = even parity, 0 = odd
+	input stop2,		// 1 = two stop bits
 	input cts,			// clear to send
 	output txd,			// external serial output
-	output reg empty, 	// buffer is empty
-    output reg txc          // tx complete flag
+	output empty, 	// fifo is empty
+	output full,		// fifo is full
+	output [pFifoAddrWidth:0] fifo_cnt,	// number of characters in fifo
+    output reg txc,          // tx complete flag
+	input dma_own,		// the dma owns the fifo, cpu writes are dropped
+	input dma_wr,		// dma writes a character to the fifo
+	input [7:0] dma_dat	// character from the dma
 );
 
-reg [9:0] tx_data;	// transmit data working reg (raw)
-reg [7:0] fdo;		// data output
+reg [11:0] tx_data;	// transmit data working reg (raw)
+wire [7:0] fdo;		// data output
 reg [7:0] cnt;		// baud clock counter
+reg [3:0] last_bit;	// last bit of the frame
 reg rd;
 
 wire isX8;
@@ -106,23 +121,44 @@ reg  modeX8;
 assign ack_o = cyc_i & stb_i & cs_i;
 assign txd = tx_data[0];
 
-always @(posedge clk_i)
-	if (ack_o & we_i) fdo <= dat_i;
+// A write queues a character, the oldest one is removed
+// once it has been loaded into the shift register.
+rtfSimpleUartFifo #(.pAddrWidth(pFifoAddrWidth)) fifo0
+(
+	.rst(rst_i),
+	.clk(clk_i),
+	.clear(1'b0),
+	.wr((ack_o & we_i & ~dma_own) | dma_wr),
+	.din(dma_wr ? dma_dat : dat_i),
+	.rd(rd),
+	.dout(fdo),
+	.cnt(fifo_cnt),
+	.empty(empty),
+	.full(full)
+);
 
-// set full / empty status
-always @(posedge clk_i)
-	if (rst_i) empty <= 1;
-	else begin
-	if (ack_o & we_i) empty <= 0;
-	else if (rd) empty <= 1;
-	end
+// The frame, lsb first: the start bit, the data bits, the parity
+// bit and the stop bits. Above the data everything is a one, the
+// parity bit is cleared into it when it is 0.
+wire [3:0] nd = 4'd5 + dbits;
+wire [7:0] fdm = fdo & (8'hFF >> ~dbits);
+wire par = ^fdm ^ ~parity_even;
+wire [11:0] frame = ({3'b000, fdm, 1'b0} | (12'hFFF << (nd + 1)))
+	& ~({11'b0, parity_en & ~par} << (nd + 1));
 
-`define CNT_FINISH (8'h9F)
+// The counter runs over the bits of the frame in 16 steps per bit
+// and a bit ends every time cnt[3:0] is F. It stops at the end of
+// the last one, CNT_FINISH, until the next frame. In 8x mode
+// (baud8x) it starts at 1 and counts in twos, so the same bit ends
+// come every 8 ticks. The mode and the format are picked up between
+// characters.
+`define CNT_FINISH ({last_bit, 4'hF})
    always @(posedge clk_i)
      if (rst_i) begin
-	cnt <= `CNT_FINISH;
+	last_bit <= 4'd9;
+	cnt <= 8'h9F;
 	rd <= 0;
-	tx_data <= 10'h3FF;
+	tx_data <= 12'hFFF;
         txc <= 1'b1;
         modeX8 <= 1'b0;
      end
@@ -136,9 +172,10 @@ always @(posedge clk_i)
 	   if (cnt==`CNT_FINISH) begin
               modeX8 <= isX8;
 	      if (!empty && cts) begin
-		 tx_data <= {1'b1,fdo,1'b0};
+		 tx_data <= frame;
+		 last_bit <= nd + parity_en + stop2 + 1;
 		 rd <= 1;
-                 cnt <= modeX8;
+                 cnt <= isX8;
                  txc <= 1'b0;
 	      end
               else
@@ -150,9 +187,27 @@ always @(posedge clk_i)
               cnt[0] <= ~cnt[0] | (modeX8);
 
               if (cnt[3:0]==4'hF)
-                tx_data <= {1'b1,tx_data[9:1]};
+                tx_data <= {1'b1,tx_data[11:1]};
            end
 	end
      end
 
+`ifdef FORMAL
+// Invariants, proved by k-induction (make prove_tx)
+
+// The bit counter stops at CNT_FINISH, the end of the frame, and
+// the transmitter only reports that it is complete while it is
+// stopped there
+tx_cnt_range: assert property (cnt <= `CNT_FINISH);
+tx_complete: assert property (txc |-> cnt == `CNT_FINISH);
+
+// ... and it does report it after a tick there with an empty fifo,
+// so LS bit 6 (fifo empty and complete) follows the fifo and the
+// counter within a tick
+reg f_tick_idle;
+always @(posedge clk_i)
+	f_tick_idle <= !rst_i && baud16x_ce && cnt == `CNT_FINISH && empty;
+tx_done: assert property (f_tick_idle |-> txc);
+`endif
+
 endmodule
@@ -0,0 +1,100 @@
+// ============================================================================
+//	(C) 2011,2013  Robert Finch
+//  All rights reserved.
+//	robfinch@<remove>finitron.ca
+//
+//	rtfSimpleUartWithDma.v
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the <organization> nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//	rtfSimpleUart with the dma engine included (pDma = 1). The
+//	port list is the same as rtfSimpleUart.
+//============================================================================
+
+module rtfSimpleUartWithDma(
+	// WISHBONE Slave interface
+	input rst_i,		// reset
+	input clk_i,		// eg 100.7MHz
+	input cyc_i,		// cycle valid
+	input stb_i,		// strobe
+	input we_i,			// 1 = write
+	input [31:0] adr_i,		// register address
+	input [7:0] dat_i,		// data input bus
+	output [7:0] dat_o,	// data output bus
+	output ack_o,		// transfer acknowledge
+	output stall_o,		// pipeline stall (pipelined mode)
+	output vol_o,		// volatile register selected
+	output irq_o,		// interrupt request
+	//----------------
+	input cts_ni,		// clear to send - active low - (flow control)
+	output rts_no,	// request to send - active low - (flow control)
+	input dsr_ni,		// data set ready - active low
+	input dcd_ni,		// data carrier detect - active low
+	output dtr_no,	// data terminal ready - active low
+	input rxd_i,			// serial data in
+	output txd_o,			// serial data out
+	output data_present_o,
+	input baud16_i,			// abstract 16x baud clock enable (pAbstractBaud = 1)
+	//----------------
+	// WISHBONE Master interface (dma)
+	output m_cyc_o,		// cycle valid
+	output m_stb_o,		// strobe
+	output m_we_o,		// 1 = write
+	output [31:0] m_adr_o,	// memory address
+	output [7:0] m_dat_o,	// data to memory
+	input [7:0] m_dat_i,	// data from memory
+	input m_ack_i		// transfer acknowledge
+);
+
+rtfSimpleUart #(.pDma(1)) uart0(
+	.rst_i(rst_i),
+	.clk_i(clk_i),
+	.cyc_i(cyc_i),
+	.stb_i(stb_i),
+	.we_i(we_i),
+	.adr_i(adr_i),
+	.dat_i(dat_i),
+	.dat_o(dat_o),
+	.ack_o(ack_o),
+	.stall_o(stall_o),
+	.vol_o(vol_o),
+	.irq_o(irq_o),
+	.cts_ni(cts_ni),
+	.rts_no(rts_no),
+	.dsr_ni(dsr_ni),
+	.dcd_ni(dcd_ni),
+	.dtr_no(dtr_no),
+	.rxd_i(rxd_i),
+	.txd_o(txd_o),
+	.data_present_o(data_present_o),
+	.baud16_i(baud16_i),
+	.m_cyc_o(m_cyc_o),
+	.m_stb_o(m_stb_o),
+	.m_we_o(m_we_o),
+	.m_adr_o(m_adr_o),
+	.m_dat_o(m_dat_o),
+	.m_dat_i(m_dat_i),
+	.m_ack_i(m_ack_i)
+);
+
+endmodule
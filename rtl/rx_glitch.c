@@ -0,0 +1,94 @@
+#include<assert.h>
+
+// ---------------------------------------------------------------------
+// Receiving through a noisy line with majority sampling (CTRL bit 2).
+//
+// The harness sends characters on rxd_i, and on every clock the line
+// may glitch: rxd_i is the inverse of what is being sent for that one
+// clock. Glitches are single clocks with at least two clean clocks
+// between them, and may land anywhere, including on the bit edges and
+// on the idle line. Every character has to arrive intact, with no
+// framing error, and the glitches on the idle line afterwards must
+// not start a character of their own.
+// ---------------------------------------------------------------------
+
+#define WB_CLOCK_HOOK noise
+#include "wishbone.h"
+
+#define BIT_CLOCKS 32       // 16 ticks, a tick every other clock
+#define CHARS 2
+
+#ifdef NATIVE_SIM
+#include <stdlib.h>
+#define nondet_u8() ((u8)rand())
+#define nondet_bool() (rand() & 1)
+#else
+u8 nondet_u8(void);
+_Bool nondet_bool(void);
+#endif
+
+u8 line = 1;                // what is being sent
+int quiet = 2;              // clean clocks since the last glitch
+
+// Called on every clock, see wishbone.h
+void noise(void) {
+  int glitch = quiet >= 2 && nondet_bool();
+  rtfSimpleUart.rxd_i = line ^ glitch;
+  quiet = glitch ? 0 : quiet + 1;
+}
+
+// One 8N1 frame on the line
+static void send(u8 c) {
+  int i;
+
+  line = 0;                 // start
+  wb_idle_n(BIT_CLOCKS);
+  for (i=0; i<8; i++) {
+    line = (c >> i) & 1;
+    wb_idle_n(BIT_CLOCKS);
+  }
+  line = 1;                 // stop
+  wb_idle_n(BIT_CLOCKS);
+}
+
+int main(void) {
+
+  u8 txmsg[CHARS];
+  u8 b;
+  int i;
+
+  rtfSimpleUart.cts_ni = 0;
+
+  // Reset
+
+  wb_reset();
+  wb_idle();
+
+  // Configure the uart
+
+  static const struct uart_reg config[] = {
+    { UART_CM3, 0x80 },     // Hella big clock multiplier!
+    { UART_CM2, 0x00 },
+    { UART_CM1, 0x00 },
+    { UART_CR, 0x04 },      // yes: majority sampling, no: hardware flow control
+    { UART_IE, 0x00 },      // no:  interrupts, we poll
+  };
+  outb_regs(config, sizeof config / sizeof config[0]);
+
+  for (i=0; i<CHARS; i++) {
+    txmsg[i] = nondet_u8();
+    send(txmsg[i]);
+  }
+
+  b = wb_wait_until(UART_LS, 0x01, 0x01, BIT_CLOCKS);
+  GOAL(b & 0x01);
+  GOAL(!(b & 0x0a));        // no framing error or overrun
+  for (i=0; i<CHARS; i++)
+    GOAL(inb(UART_TR) == txmsg[i]);
+
+  // Long enough for a false start to make it into the fifo
+  wb_idle_n(11 * BIT_CLOCKS);
+  GOAL(!(inb(UART_LS) & 0x01));
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+/*
+  Native simulation backend, see native.h.
+
+  The model is built by verilator with --prefix Vuart, whichever
+  module is the top.
+
+  The harnesses draw their nondet values from rand(), seeded from
+  $NATIVE_SEED if it's set, so each seed takes another path.
+
+  Built with NATIVE_TRACE (and verilator --trace-fst), the run writes
+  an FST trace to $NATIVE_TRACE_FILE as it goes, two timesteps per
+  clock: the inputs applied, then the clock edge. A failing GOAL or
+  assert aborts the run, which skips atexit(), so the trace is also
+  closed from a SIGABRT handler: the failing run is the one whose
+  waveform is wanted.
+*/
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include "Vuart.h"
+#include "verilated.h"
+#ifdef NATIVE_TRACE
+#include "verilated_fst_c.h"
+#endif
+#include "native.h"
+
+struct module_rtfSimpleUart rtfSimpleUart;
+
+static Vuart *top;
+static unsigned long cycles;
+
+// Before main(), ahead of any rand() in the harness
+static struct native_seed {
+  native_seed() {
+    const char *seed = getenv("NATIVE_SEED");
+    if (seed)
+      srand(strtoul(seed, 0, 0));
+  }
+} native_seed;
+
+#ifdef NATIVE_TRACE
+static VerilatedFstC *tfp;
+
+static void trace_abort(int sig);
+
+static void trace_open(void) {
+  const char *file = getenv("NATIVE_TRACE_FILE");
+  Verilated::traceEverOn(true);
+  tfp = new VerilatedFstC;
+  top->trace(tfp, 99);
+  tfp->open(file ? file : "native.fst");
+  signal(SIGABRT, trace_abort);
+}
+
+static void trace_dump(uint64_t t) {
+  tfp->dump(t);
+}
+
+static void trace_close(void) {
+  if (!tfp)
+    return;
+  tfp->close();
+  delete tfp;
+  tfp = 0;
+}
+
+// The abort comes from a failing check in the harness, between
+// clocks rather than inside a dump, so the trace can be finished
+// here. The inputs of the failing clock go in first.
+static void trace_abort(int sig) {
+  trace_dump(2 * cycles);
+  trace_close();
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+#else
+static void trace_open(void) { }
+static void trace_dump(uint64_t t) { }
+static void trace_close(void) { }
+#endif
+
+static void copy_inputs(void) {
+  top->rst_i = rtfSimpleUart.rst_i;
+  top->cyc_i = rtfSimpleUart.cyc_i;
+  top->stb_i = rtfSimpleUart.stb_i;
+  top->we_i = rtfSimpleUart.we_i;
+  top->adr_i = rtfSimpleUart.adr_i;
+  top->dat_i = rtfSimpleUart.dat_i;
+  top->cts_ni = rtfSimpleUart.cts_ni;
+  top->dsr_ni = rtfSimpleUart.dsr_ni;
+  top->dcd_ni = rtfSimpleUart.dcd_ni;
+  top->rxd_i = rtfSimpleUart.rxd_i;
+  top->baud16_i = rtfSimpleUart.baud16_i;
+  top->m_dat_i = rtfSimpleUart.m_dat_i;
+  top->m_ack_i = rtfSimpleUart.m_ack_i;
+}
+
+static void copy_outputs(void) {
+  rtfSimpleUart.dat_o = top->dat_o;
+  rtfSimpleUart.ack_o = top->ack_o;
+  rtfSimpleUart.stall_o = top->stall_o;
+  rtfSimpleUart.vol_o = top->vol_o;
+  rtfSimpleUart.irq_o = top->irq_o;
+  rtfSimpleUart.rts_no = top->rts_no;
+  rtfSimpleUart.dtr_no = top->dtr_no;
+  rtfSimpleUart.txd_o = top->txd_o;
+  rtfSimpleUart.data_present_o = top->data_present_o;
+  rtfSimpleUart.m_cyc_o = top->m_cyc_o;
+  rtfSimpleUart.m_stb_o = top->m_stb_o;
+  rtfSimpleUart.m_we_o = top->m_we_o;
+  rtfSimpleUart.m_adr_o = top->m_adr_o;
+  rtfSimpleUart.m_dat_o = top->m_dat_o;
+}
+
+static void destroy(void) {
+  fprintf(stderr, "%lu cycles\n", cycles);
+  trace_close();
+  top->final();
+  delete top;
+}
+
+extern "C" void set_inputs(void) {
+  if (!top) {
+    top = new Vuart;
+    top->clk_i = 0;
+    trace_open();
+    atexit(destroy);
+  }
+  copy_inputs();
+  top->eval();
+  copy_outputs();
+}
+
+extern "C" void next_timeframe(void) {
+  // Inputs only reach the model through set_inputs(), as with
+  // hw-cbmc.
+  trace_dump(2 * cycles);
+  top->clk_i = 1;
+  top->eval();
+  trace_dump(2 * cycles + 1);
+  top->clk_i = 0;
+  top->eval();
+  cycles++;
+  copy_outputs();
+}
+
+extern "C" unsigned long native_cycles(void) {
+  return cycles;
+}
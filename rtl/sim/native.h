@@ -0,0 +1,76 @@
+/*
+  Native simulation backend for the harnesses.
+
+  Stands in for the interface header generated by
+  hw-cbmc --gen-interface: the same struct, set_inputs() and
+  next_timeframe(), but backed by a verilator model of the top
+  module, so a harness runs as an ordinary executable instead of
+  being unrolled by the model checker.
+
+  Every top module (rtfSimpleUart, rtfSimpleUartPipelined,
+  rtfSimpleUartWithDma) has the same port list; which one is
+  simulated is decided when the model is built, see the Makefile.
+*/
+
+#ifndef NATIVE_H
+#define NATIVE_H
+
+typedef unsigned char _u8;
+typedef unsigned short _u16;
+typedef unsigned int _u32;
+
+struct module_rtfSimpleUart {
+  // WISHBONE Slave interface
+  _u8 rst_i;
+  _u8 clk_i;
+  _u8 cyc_i;
+  _u8 stb_i;
+  _u8 we_i;
+  _u32 adr_i;
+  _u8 dat_i;
+  _u8 dat_o;
+  _u8 ack_o;
+  _u8 stall_o;
+  _u8 vol_o;
+  _u8 irq_o;
+  // Serial / modem
+  _u8 cts_ni;
+  _u8 rts_no;
+  _u8 dsr_ni;
+  _u8 dcd_ni;
+  _u8 dtr_no;
+  _u8 rxd_i;
+  _u8 txd_o;
+  _u8 data_present_o;
+  _u8 baud16_i;
+  // WISHBONE Master interface (dma)
+  _u8 m_cyc_o;
+  _u8 m_stb_o;
+  _u8 m_we_o;
+  _u32 m_adr_o;
+  _u8 m_dat_o;
+  _u8 m_dat_i;
+  _u8 m_ack_i;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern struct module_rtfSimpleUart rtfSimpleUart;
+
+// Apply the inputs for the current timeframe and update the
+// outputs that depend on them combinationally.
+void set_inputs(void);
+
+// Clock edge: move on to the next timeframe.
+void next_timeframe(void);
+
+// Number of clock edges simulated so far.
+unsigned long native_cycles(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,355 @@
+/*
+  Transaction-level model of rtfSimpleUart.
+
+  An untimed C model of the register file and of the receiver and
+  transmitter fifos, for firmware that doesn't care about bit timing.
+  There are no clocks: register accesses take effect at once, and a
+  character moves across the line on each call to tlm_step(), which
+  stands for one character time. The WB_TLM backend in wishbone.h runs
+  the harnesses against it (make <harness>_tlm); tlm_equiv.c checks it
+  against the rtl with hw-cbmc at the transaction boundaries.
+
+  Not modelled: bit timing, framing and parity errors (every frame
+  is well formed), the autobaud measurement (the sync character is
+  swallowed, but the multiplier stays as it was), the one clock dcd change pulse (MS bit 3 and the modem
+  status interrupt are always 0) and the dma engine.
+*/
+
+#ifndef TLM_H
+#define TLM_H
+
+#define TLM_FIFO_DEPTH 16       // pRxFifoAddrWidth = pTxFifoAddrWidth = 4
+#define TLM_TIMEOUT_STEPS 4     // the character timeout, pTimeout = 640 ticks
+
+// Reset value of the clock multiplier, the pClkMul parameter
+#define TLM_CLK_FREQ 20000000
+#define TLM_BAUD 19200
+#define TLM_CLK_MUL ((4096UL * TLM_BAUD) / (TLM_CLK_FREQ / 65536) * 256)
+
+#define TLM_BASE 0xffdc0a00     // UART_TR
+
+struct tlm_fifo {
+  unsigned char mem[TLM_FIFO_DEPTH];
+  int rp;
+  int cnt;
+};
+
+struct uart_tlm {
+  // Serial / modem, named after the rtl ports
+  unsigned char cts_ni;
+  unsigned char rts_no;
+  unsigned char dsr_ni;
+  unsigned char dcd_ni;
+  unsigned char dtr_no;
+  unsigned char irq_o;
+  unsigned char data_present_o;
+  // Registers
+  unsigned char rx_present_ie;
+  unsigned char tx_empty_ie;
+  unsigned char dcd_ie;
+  unsigned char loopback;
+  unsigned char hwfc;
+  unsigned char baud8x;         // only read back, a step is a character either way
+  unsigned char majority;       // only read back, there are no glitches
+  unsigned char autobaud;       // armed, the next character is the sync one
+  unsigned char autorts;
+  unsigned char rts;            // the modem control bit, rts_no is the pin
+  unsigned char rts_hi;         // watermarks, in sixteenths of the fifo
+  unsigned char rts_lo;
+  unsigned char rts_off;        // the fifo went above the high-water mark
+  unsigned char ff;             // frame format, only the data bits matter here
+  unsigned long ck_mul;
+  unsigned char fifo_trig;
+  unsigned char rx_trig;
+  unsigned char tx_trig;
+  unsigned char spr;
+  // Receiver
+  struct tlm_fifo rx;
+  unsigned char overrun;
+  unsigned char frame_err;
+  int rx_idle;                  // steps since the fifo was last written or read
+  unsigned char rxd_valid;      // a character waiting on rxd_i, see tlm_receive()
+  unsigned char rxd;
+  // Transmitter
+  struct tlm_fifo tx;
+  unsigned char tx_busy;        // a character is on its way out
+  unsigned char tx_shift;
+  unsigned long tx_sent;        // characters that went out on txd_o
+  unsigned char txd;            // the last of them
+};
+
+static inline void tlm_push(struct tlm_fifo *f, unsigned char b) {
+  f->mem[(f->rp + f->cnt) % TLM_FIFO_DEPTH] = b;
+  f->cnt++;
+}
+
+static inline unsigned char tlm_pop(struct tlm_fifo *f) {
+  unsigned char b = f->mem[f->rp];
+  f->rp = (f->rp + 1) % TLM_FIFO_DEPTH;
+  f->cnt--;
+  return b;
+}
+
+// Fifo trigger levels, in characters
+static inline int tlm_rx_trig_lvl(const struct uart_tlm *u) {
+  return u->rx_trig == 3 ? TLM_FIFO_DEPTH : TLM_FIFO_DEPTH * (u->rx_trig + 1) / 4;
+}
+
+// most characters left in the transmitter fifo
+static inline int tlm_tx_trig_lvl(const struct uart_tlm *u) {
+  return TLM_FIFO_DEPTH * (3 - u->tx_trig) / 4;
+}
+
+// Automatic rts, from the receiver fifo level; the marks are in
+// sixteenths of the fifo depth
+static inline void tlm_rts(struct uart_tlm *u) {
+  if (16 * u->rx.cnt >= u->rts_hi * TLM_FIFO_DEPTH)
+    u->rts_off = 1;
+  else if (16 * u->rx.cnt <= u->rts_lo * TLM_FIFO_DEPTH)
+    u->rts_off = 0;
+  u->rts_no = !u->rts || (u->autorts && u->rts_off);
+}
+
+// The cts line, in loopback mode from rts or the receiver fifo
+static inline int tlm_cts_line(const struct uart_tlm *u) {
+  if (u->loopback)
+    return u->autorts ? !u->rts_no : u->rx.cnt < TLM_FIFO_DEPTH;
+  return !u->cts_ni;
+}
+
+// Clear to send, as the transmitter sees it
+static inline int tlm_cts(const struct uart_tlm *u) {
+  return !u->hwfc || tlm_cts_line(u);
+}
+
+// Interrupt encoding, as in the IS register: 0 = none
+static inline int tlm_irqenc(const struct uart_tlm *u) {
+  int rx_ready = u->fifo_trig ? u->rx.cnt >= tlm_rx_trig_lvl(u) : u->rx.cnt != 0;
+  int tx_ready = u->fifo_trig ? u->tx.cnt <= tlm_tx_trig_lvl(u) : u->tx.cnt == 0;
+  int timeout = u->rx.cnt != 0 && u->rx_idle >= TLM_TIMEOUT_STEPS;
+
+  if (rx_ready && u->rx_present_ie)
+    return 1;
+  if (u->fifo_trig && timeout && u->rx_present_ie)
+    return 2;
+  if (tx_ready && u->tx_empty_ie)
+    return 3;
+  return 0;
+}
+
+static inline void tlm_outputs(struct uart_tlm *u) {
+  tlm_rts(u);
+  u->irq_o = tlm_irqenc(u) != 0;
+  u->data_present_o = u->rx.cnt != 0;
+}
+
+static inline void tlm_reset(struct uart_tlm *u) {
+  u->rts = 1;                   // pRts
+  u->rts_no = 0;
+  u->dtr_no = 0;                // pDtr
+  u->rx_present_ie = 0;
+  u->tx_empty_ie = 0;
+  u->dcd_ie = 0;
+  u->loopback = 0;
+  u->hwfc = 1;
+  u->baud8x = 0;
+  u->majority = 0;
+  u->autobaud = 0;
+  u->autorts = 0;
+  u->rts_hi = 12;               // 3/4 of the fifo
+  u->rts_lo = 4;                // 1/4
+  u->rts_off = 0;
+  u->ff = 0x03;
+  u->ck_mul = TLM_CLK_MUL;
+  u->fifo_trig = 0;
+  u->rx_trig = 0;
+  u->tx_trig = 0;
+  u->spr = 0;
+  u->rx.rp = 0;
+  u->rx.cnt = 0;
+  u->overrun = 0;
+  u->frame_err = 0;
+  u->rx_idle = 0;
+  u->rxd_valid = 0;
+  u->tx.rp = 0;
+  u->tx.cnt = 0;
+  u->tx_busy = 0;
+  u->tx_sent = 0;
+  tlm_outputs(u);
+}
+
+// The data bits of a character in the current frame format
+static inline unsigned char tlm_data_bits(const struct uart_tlm *u, unsigned char b) {
+  return b & (0xff >> (3 - (u->ff & 3)));
+}
+
+// A character arrives at the receiver
+static inline void tlm_rx_frame(struct uart_tlm *u, unsigned char b) {
+  if (u->autobaud) {
+    u->autobaud = 0;
+    return;
+  }
+  u->overrun = u->rx.cnt == TLM_FIFO_DEPTH;
+  if (!u->overrun)
+    tlm_push(&u->rx, tlm_data_bits(u, b));
+  u->frame_err = 0;
+  u->rx_idle = 0;
+}
+
+// Queue a character on rxd_i, it is received on the next step
+// (unless the uart is in loopback mode)
+static inline void tlm_receive(struct uart_tlm *u, unsigned char b) {
+  u->rxd = b;
+  u->rxd_valid = 1;
+}
+
+// One character time: the character on its way out arrives, and the
+// transmitter takes the next one from its fifo
+static inline void tlm_step(struct uart_tlm *u) {
+  int received = 0;
+
+  if (u->rx.cnt != 0)
+    u->rx_idle++;
+  if (u->tx_busy) {
+    if (u->loopback) {
+      tlm_rx_frame(u, u->tx_shift);
+      received = 1;
+    } else {
+      u->txd = u->tx_shift;
+      u->tx_sent++;
+    }
+    u->tx_busy = 0;
+  }
+  if (u->rxd_valid && !u->loopback && !received)
+    tlm_rx_frame(u, u->rxd);
+  u->rxd_valid = 0;
+  tlm_rts(u);
+  if (u->tx.cnt != 0 && tlm_cts(u)) {
+    u->tx_shift = tlm_data_bits(u, tlm_pop(&u->tx));
+    u->tx_busy = 1;
+  }
+  tlm_outputs(u);
+}
+
+static inline void tlm_write(struct uart_tlm *u, unsigned long port, unsigned char b) {
+  int sh;
+
+  if (port - TLM_BASE >= 16)
+    return;
+  switch (port - TLM_BASE) {
+  case 0:       // TRB
+    if (u->tx.cnt < TLM_FIFO_DEPTH)
+      tlm_push(&u->tx, b);
+    break;
+  case 4:       // IER
+    u->rx_present_ie = b & 1;
+    u->tx_empty_ie = (b >> 1) & 1;
+    u->dcd_ie = (b >> 3) & 1;
+    break;
+  case 5:       // FF
+    u->ff = b & 0x1f;
+    break;
+  case 6:       // MC
+    u->dtr_no = !(b & 1);
+    u->rts = (b >> 1) & 1;
+    u->loopback = (b >> 4) & 1;
+    break;
+  case 7:       // CTRL
+    u->hwfc = b & 1;
+    u->baud8x = (b >> 1) & 1;
+    u->majority = (b >> 2) & 1;
+    u->autobaud = (b >> 3) & 1;
+    u->autorts = (b >> 4) & 1;
+    break;
+  case 8:       // CLKM0
+  case 9:       // CLKM1
+  case 10:      // CLKM2
+  case 11:      // CLKM3
+    sh = 8 * (port - TLM_BASE - 8);
+    u->ck_mul = (u->ck_mul & ~(0xffUL << sh)) | (unsigned long)b << sh;
+    break;
+  case 12:      // FC
+    u->fifo_trig = b & 1;
+    u->rx_trig = (b >> 1) & 3;
+    u->tx_trig = (b >> 3) & 3;
+    break;
+  case 13:      // clear the receiver
+    u->rx.rp = 0;
+    u->rx.cnt = 0;
+    u->overrun = 0;
+    u->frame_err = 0;
+    u->rx_idle = 0;
+    break;
+  case 14:      // RTSW
+    u->rts_hi = b & 0xf;
+    u->rts_lo = b >> 4;
+    break;
+  case 15:      // SPR
+    u->spr = b;
+    break;
+  default:
+    break;
+  }
+  tlm_outputs(u);
+}
+
+static inline unsigned char tlm_read(struct uart_tlm *u, unsigned long port) {
+  unsigned char b = 0;
+  int cts = tlm_cts_line(u);
+
+  if (port - TLM_BASE >= 16)
+    return 0;
+  switch (port - TLM_BASE) {
+  case 0:       // TRB, 0 when there is nothing
+    if (u->rx.cnt != 0)
+      b = tlm_pop(&u->rx);
+    u->rx_idle = 0;
+    break;
+  case 1:       // LS
+    b = (u->tx.cnt == 0 && !u->tx_busy) << 6 |
+        (u->tx.cnt < TLM_FIFO_DEPTH) << 5 |
+        u->frame_err << 3 |
+        u->overrun << 1 |
+        (u->rx.cnt != 0);
+    break;
+  case 2:       // MS
+    b = !u->dcd_ni << 7 | !u->dsr_ni << 5 | cts << 4;
+    break;
+  case 3:       // IS
+    b = u->irq_o << 7 | tlm_irqenc(u) << 2;
+    break;
+  case 4:       // IER
+    b = u->dcd_ie << 3 | u->tx_empty_ie << 1 | u->rx_present_ie;
+    break;
+  case 5:       // FF
+    b = u->ff;
+    break;
+  case 6:       // MC
+    b = u->loopback << 4 | u->rts << 1 | !u->dtr_no;
+    break;
+  case 7:       // CTRL
+    b = u->autorts << 4 | u->autobaud << 3 | u->majority << 2 | u->baud8x << 1 | u->hwfc;
+    break;
+  case 8:       // CLKM0
+  case 9:       // CLKM1
+  case 10:      // CLKM2
+  case 11:      // CLKM3
+    b = (u->ck_mul >> 8 * (port - TLM_BASE - 8)) & 0xff;
+    break;
+  case 12:      // FC
+    b = u->tx_trig << 3 | u->rx_trig << 1 | u->fifo_trig;
+    break;
+  case 14:      // RTSW
+    b = u->rts_lo << 4 | u->rts_hi;
+    break;
+  case 15:      // SPR
+    b = u->spr;
+    break;
+  default:      // 13 reads as 0
+    break;
+  }
+  tlm_outputs(u);
+  return b;
+}
+
+#endif
@@ -0,0 +1,81 @@
+#!/bin/sh
+# ---------------------------------------------------------------------
+# Shrinks a counterexample trace from hw-cbmc: keeps only the signals
+# listed in waves.gtkw, drops the timestamps where none of them
+# change, and converts the result to FST with vcd2fst (it comes with
+# gtkwave) when that is installed. The trace is read once, as a
+# stream.
+#
+#   ./waves.sh [-g savefile] trace.vcd
+#
+# Leaves trace.fst, or the filtered trace.vcd without vcd2fst, and
+# prints its name.
+# ---------------------------------------------------------------------
+
+GTKW=$(dirname "$0")/waves.gtkw
+VCD2FST=${VCD2FST:-vcd2fst}
+
+while getopts g: opt; do
+  case $opt in
+  g) GTKW=$OPTARG ;;
+  *) echo "usage: $0 [-g savefile] trace.vcd" >&2; exit 2 ;;
+  esac
+done
+shift $((OPTIND - 1))
+vcd=$1
+[ -f "$vcd" ] || exit 0         # no counterexample, no trace
+
+# Signal names from the save file, without scope and bit range
+signals=$(grep -v '^[][@*#-]' "$GTKW" | sed 's/\[[^]]*\]$//; s/.*[.\\]//' | sort -u | tr '\n' ' ')
+
+awk -v signals="$signals" '
+BEGIN {
+  n = split(signals, s, " ")
+  for (i = 1; i <= n; i++)
+    want[s[i]] = 1
+}
+# Definitions: keep the wanted variables, remember their codes
+!body && $1 == "$var" {
+  ref = $5
+  sub(/.*[.\\]/, "", ref)
+  if (ref in want) {
+    keep[$4] = 1
+    print
+  }
+  next
+}
+!body {
+  print
+  if ($1 == "$enddefinitions")
+    body = 1
+  next
+}
+# Value changes: a timestamp is only written out once something
+# under it is
+/^#/ {
+  stamp = $0
+  next
+}
+/^[bBrR]/ {
+  if (!($2 in keep))
+    next
+}
+/^[01xXzZ]/ {
+  if (!(substr($1, 2) in keep))
+    next
+}
+{
+  if (stamp != "") {
+    print stamp
+    stamp = ""
+  }
+  print
+}
+' "$vcd" > "$vcd.tmp" || exit 2
+
+if command -v "$VCD2FST" > /dev/null; then
+  fst=${vcd%.vcd}.fst
+  "$VCD2FST" "$vcd.tmp" "$fst" > /dev/null && rm -f "$vcd" "$vcd.tmp" && echo "$fst" && exit 0
+fi
+mv "$vcd.tmp" "$vcd"
+echo "$vcd"
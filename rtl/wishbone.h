@@ -0,0 +1,683 @@
+// ---------------------------------------------------------------------
+// Wishbone transactions, Linux-style inb/outb and the UART register
+// map, shared by all the harnesses.
+//
+// The backend is selected at compile time:
+//
+//   (default)      hw-cbmc, rtfSimpleUart
+//   WB_PIPELINED   hw-cbmc, rtfSimpleUartPipelined, B4 pipelined cycles
+//   WB_DMA         hw-cbmc, rtfSimpleUartWithDma
+//   WB_ABSTRACT_BAUD  hw-cbmc, rtfSimpleUartAbstractBaud, the harness
+//                  drives nondeterministic baud ticks, see below
+//   NATIVE_SIM     verilator model, see sim/native.h (combines with
+//                  the others, the top is picked by the Makefile)
+//   WB_TLM         untimed transaction-level model, see sim/tlm.h,
+//                  compiled natively
+//   WB_THREADED    inb/outb run in a firmware thread and reach the
+//                  wb_* functions in a hardware thread through a
+//                  channel (tempabs harnesses)
+//
+// A harness that has to act on every clock, eg. a memory model on
+// the dma master port, defines WB_CLOCK_HOOK to the name of a
+// void (void) function before including this file. It is called
+// just before set_inputs() on every clock.
+// ---------------------------------------------------------------------
+
+#ifndef WISHBONE_H
+#define WISHBONE_H
+
+#include <assert.h>
+#ifdef NATIVE_SIM
+#include <stdio.h>
+#endif
+
+#if defined(WB_TLM)
+#include "sim/tlm.h"
+typedef unsigned char _u8;
+typedef unsigned int _u32;
+struct uart_tlm rtfSimpleUart;
+#elif defined(NATIVE_SIM)
+#include "sim/native.h"
+#elif defined(WB_PIPELINED)
+#include "rtfSimpleUartPipelined.h"
+#define rtfSimpleUart rtfSimpleUartPipelined
+#elif defined(WB_DMA)
+#include "rtfSimpleUartWithDma.h"
+#define rtfSimpleUart rtfSimpleUartWithDma
+#elif defined(WB_ABSTRACT_BAUD)
+#include "rtfSimpleUartAbstractBaud.h"
+#define rtfSimpleUart rtfSimpleUartAbstractBaud
+#else
+#include "rtfSimpleUart.h"
+#endif
+
+#ifdef WB_CLOCK_HOOK
+void WB_CLOCK_HOOK(void);
+#else
+#define WB_CLOCK_HOOK() do { } while (0)
+#endif
+
+// ---------------------------------------------------------------------
+// Abstract baud ticks
+//
+// Against rtfSimpleUartAbstractBaud the baud rate generator is gone
+// and the harness supplies the 16x clock enable on baud16_i: on every
+// clock a tick may or may not happen, except that there are never
+// WB_BAUD_GAP clocks in a row without one. That takes in the ticks of
+// every clock multiplier between 2^32/WB_BAUD_GAP and 2^31, including
+// their jitter (see rtfSimpleUartBaud.v, and baud_refine.c for the
+// check), so one run covers all of those baud rates.
+// ---------------------------------------------------------------------
+
+#ifdef WB_ABSTRACT_BAUD
+
+#ifndef WB_BAUD_GAP
+#define WB_BAUD_GAP 4
+#endif
+
+#ifdef NATIVE_SIM
+#include <stdlib.h>
+#define wb_nondet_tick() (rand() & 1)
+#else
+_Bool nondet_bool(void);
+#define wb_nondet_tick() nondet_bool()
+#endif
+
+int wb_baud_gap;	// clocks since the last tick
+
+static inline void wb_baud_tick(void) {
+  rtfSimpleUart.baud16_i = wb_baud_gap == WB_BAUD_GAP-1 || wb_nondet_tick();
+  wb_baud_gap = rtfSimpleUart.baud16_i ? 0 : wb_baud_gap + 1;
+}
+
+#else
+#define wb_baud_tick() do { } while (0)
+#endif
+
+// Every clock goes through here, just before set_inputs()
+#define wb_set_inputs() do { WB_CLOCK_HOOK(); wb_baud_tick(); set_inputs(); } while (0)
+
+typedef unsigned char u8;
+
+// ---------------------------------------------------------------------
+// UART addresses
+// Some of these are not implemented yet in the opencores UART.
+// ---------------------------------------------------------------------
+
+#define UART_TR 0xffdc0a00         // tx/rx data (RW)
+#define UART_LS (UART_TR + 1)      // line status (RO)
+#define UART_MS (UART_TR + 2)      // modem status (RO)
+#define UART_IS (UART_TR + 3)      // interrupt status (RO)
+#define UART_IE (UART_TR + 4)      // interrupt enable (RW)
+#define UART_FF (UART_TR + 5)      // frame format (RW)
+#define UART_MC (UART_TR + 6)      // modem control (RW)
+#define UART_CR (UART_TR + 7)      // uart control (RW)
+#define UART_CM0 (UART_TR + 8)     // clock multiplier byte 0 - least significant (RW)
+#define UART_CM1 (UART_TR + 9)     //                  byte 1
+#define UART_CM2 (UART_TR + 10)    //                  byte 2
+#define UART_CM3 (UART_TR + 11)    //                  byte 3 - most significant (RW)
+#define UART_FC (UART_TR + 12)     // fifo control (RW)
+#define UART_RTSW (UART_TR + 14)   // rts watermarks (RW)
+#define UART_SPR (UART_TR + 15)    // scratchpad (RW)
+
+// DMA registers (rtfSimpleUartWithDma)
+#define UART_DMA_AD0 (UART_TR + 16) // memory address byte 0 - least significant (RW)
+#define UART_DMA_AD1 (UART_TR + 17) //                byte 1
+#define UART_DMA_AD2 (UART_TR + 18) //                byte 2
+#define UART_DMA_AD3 (UART_TR + 19) //                byte 3 - most significant (RW)
+#define UART_DMA_LN0 (UART_TR + 20) // length byte 0 - least significant (RW)
+#define UART_DMA_LN1 (UART_TR + 21) //        byte 1 - most significant (RW)
+#define UART_DMA_CTL (UART_TR + 22) // dma control (RW)
+#define UART_DMA_ST (UART_TR + 23)  // dma status (RW)
+
+// ---------------------------------------------------------------------
+// Transactions on the wishbone interface
+// These are clock-aware; each call to next_timeframe corresponds to
+// one clock cycle.
+// ---------------------------------------------------------------------
+
+#ifdef WB_TLM
+
+// Against the transaction-level model there are no clocks: every
+// transaction and every idle is one step of the model, ie. one
+// character time on the line.
+
+static inline void wb_reset(void) {
+  tlm_reset(&rtfSimpleUart);
+}
+
+static inline void wb_idle(void) {
+  WB_CLOCK_HOOK();
+  tlm_step(&rtfSimpleUart);
+}
+
+static inline void wb_idle_n(int n) {
+  int i;
+  for (i=0; i<n; i++)
+    wb_idle();
+}
+
+static inline void wb_write(_u32 addr, _u8 b) {
+  tlm_write(&rtfSimpleUart, addr, b);
+  wb_idle();
+}
+
+static inline _u8 wb_read(_u32 addr) {
+  _u8 b = tlm_read(&rtfSimpleUart, addr);
+  wb_idle();
+  return b;
+}
+
+static inline void wb_block_write(_u32 addr, _u8 *buf, int n) {
+  int i;
+  for (i=0; i<n; i++)
+    wb_write(addr, buf[i]);
+}
+
+static inline void wb_block_read(_u32 addr, _u8 *buf, int n) {
+  int i;
+  for (i=0; i<n; i++)
+    buf[i] = wb_read(addr);
+}
+
+#else
+
+static inline void wb_reset(void) {
+  rtfSimpleUart.rst_i = 1;
+  wb_set_inputs();
+  next_timeframe();
+  rtfSimpleUart.rst_i = 0;
+  // Rule 3.20
+  rtfSimpleUart.stb_i = 0; rtfSimpleUart.cyc_i = 0;
+}
+
+static inline void wb_idle(void) {
+  wb_set_inputs();
+  next_timeframe();
+}
+
+// n idle clocks
+static inline void wb_idle_n(int n) {
+  int i;
+  for (i=0; i<n; i++)
+    wb_idle();
+}
+
+#ifdef WB_PIPELINED
+
+// Pipelined mode (Wishbone B4): the request is accepted on the clock
+// where STB is high and STALL is low, the acknowledge and the read
+// data come back registered on the following clock.
+
+static inline void wb_write(_u32 addr, _u8 b) {
+  // Master presents address, data, asserts WE, CYC and STB
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.dat_i = b;
+  rtfSimpleUart.we_i = 1;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  wb_set_inputs();
+  assert(rtfSimpleUart.stall_o == 0);
+  next_timeframe();
+  // Request accepted, wait for the acknowledge
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.stb_i = 0;
+  wb_set_inputs();
+  assert(rtfSimpleUart.ack_o == 1);
+  next_timeframe();
+  rtfSimpleUart.cyc_i = 0;
+}
+
+static inline _u8 wb_read(_u32 addr) {
+  // Master presents address, asserts CYC and STB, deasserts WE
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  wb_set_inputs();
+  assert(rtfSimpleUart.stall_o == 0);
+  next_timeframe();
+  // Request accepted, data comes with the acknowledge
+  rtfSimpleUart.stb_i = 0;
+  wb_set_inputs();
+  assert(rtfSimpleUart.ack_o == 1);
+  _u8 b = rtfSimpleUart.dat_o;
+  next_timeframe();
+  rtfSimpleUart.cyc_i = 0;
+  return b;
+}
+
+#else
+
+static inline void wb_write(_u32 addr, _u8 b) {
+  // Master presents address, data, asserts WE, CYC and STB
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.dat_i = b;
+  rtfSimpleUart.we_i = 1;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  wb_set_inputs();
+  //assert(rtfSimpleUart.ack_o == 1);
+  // We assume the acknowledge comes right away.
+  // NB Wishbone does not guarantee this in general!
+  // The simple UART appears to derive ack_o combinatorially from stb_i and cyc_i.
+  next_timeframe();
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 0;
+  rtfSimpleUart.stb_i = 0;
+}
+
+static inline _u8 wb_read(_u32 addr) {
+  // Master presents address, data, asserts CYC and STB, deasserts WE
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  wb_set_inputs();
+  //assert(rtfSimpleUart.ack_o == 1);
+  // We assume the acknowledge comes right away.
+  // NB Wishbone does not guarantee this in general!
+  // The simple UART appears to derive ack_o combinatorially from stb_i and cyc_i.
+  _u8 b = rtfSimpleUart.dat_o;
+  next_timeframe();
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 0;
+  rtfSimpleUart.stb_i = 0;
+  return b;
+}
+
+#endif
+
+// Block transfers: the master holds CYC for the whole block and
+// presents one beat per clock, so n bytes take n clocks plus the
+// clock on which the cycle ends. Used against UART_TR, each beat
+// fills or drains one fifo entry.
+
+#ifdef WB_PIPELINED
+
+// In pipelined mode a new request goes out on every clock and the
+// acknowledges trail the requests by one clock.
+static inline void wb_block_write(_u32 addr, _u8 *buf, int n) {
+  int i;
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.we_i = 1;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  for (i=0; i<n; i++) {
+    rtfSimpleUart.dat_i = buf[i];
+    wb_set_inputs();
+    assert(rtfSimpleUart.stall_o == 0);
+    if (i > 0)
+      assert(rtfSimpleUart.ack_o == 1);
+    next_timeframe();
+  }
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.stb_i = 0;
+  wb_set_inputs();
+  assert(rtfSimpleUart.ack_o == 1);
+  next_timeframe();
+  rtfSimpleUart.cyc_i = 0;
+}
+
+static inline void wb_block_read(_u32 addr, _u8 *buf, int n) {
+  int i;
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  for (i=0; i<n; i++) {
+    wb_set_inputs();
+    assert(rtfSimpleUart.stall_o == 0);
+    if (i > 0) {
+      assert(rtfSimpleUart.ack_o == 1);
+      buf[i-1] = rtfSimpleUart.dat_o;
+    }
+    next_timeframe();
+  }
+  rtfSimpleUart.stb_i = 0;
+  wb_set_inputs();
+  assert(rtfSimpleUart.ack_o == 1);
+  buf[n-1] = rtfSimpleUart.dat_o;
+  next_timeframe();
+  rtfSimpleUart.cyc_i = 0;
+}
+
+#else
+
+static inline void wb_block_write(_u32 addr, _u8 *buf, int n) {
+  int i;
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.we_i = 1;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  for (i=0; i<n; i++) {
+    rtfSimpleUart.dat_i = buf[i];
+    wb_set_inputs();
+    next_timeframe();
+  }
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 0;
+  rtfSimpleUart.stb_i = 0;
+}
+
+static inline void wb_block_read(_u32 addr, _u8 *buf, int n) {
+  int i;
+  rtfSimpleUart.adr_i = addr;
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 1;
+  rtfSimpleUart.stb_i = 1;
+  for (i=0; i<n; i++) {
+    wb_set_inputs();
+    buf[i] = rtfSimpleUart.dat_o;
+    next_timeframe();
+  }
+  rtfSimpleUart.we_i = 0;
+  rtfSimpleUart.cyc_i = 0;
+  rtfSimpleUart.stb_i = 0;
+}
+
+#endif
+
+#endif /* WB_TLM */
+
+// ---------------------------------------------------------------------
+// Polled waits
+//
+// wb_wait_until() reads reg until (value & mask) == match, or gives
+// up once max_cycles clocks have gone by, and returns the last value
+// read for the harness to check. Unlike a fixed run of wb_idle()s it
+// stops as soon as the condition holds. Only use it on registers
+// that can be read without side effects (LS, IS, MS, the dma
+// registers).
+//
+// The native backend prints how many clocks each wait took, and the
+// total for the run when it exits, so the max_cycles arguments and
+// the bounds in the Makefile can be set from measurements.
+// ---------------------------------------------------------------------
+
+#ifdef WB_PIPELINED
+#define WB_READ_CYCLES 2
+#else
+#define WB_READ_CYCLES 1
+#endif
+
+static inline _u8 wb_wait_until(_u32 reg, _u8 mask, _u8 match, int max_cycles) {
+  int n = WB_READ_CYCLES;
+  _u8 b = wb_read(reg);
+  while ((b & mask) != match && n < max_cycles) {
+    b = wb_read(reg);
+    n += WB_READ_CYCLES;
+  }
+#ifdef NATIVE_SIM
+  fprintf(stderr, "wb_wait_until(%#x, %#x, %#x): %d of %d cycles%s\n",
+          reg, mask, match, n, max_cycles,
+          (b & mask) == match ? "" : ", timed out");
+#endif
+  return b;
+}
+
+// ---------------------------------------------------------------------
+// Goals
+//
+// Harness checks are written GOAL(cond) rather than assert(cond), so
+// that goals.sh can solve each one on its own with the bound it
+// needs, instead of all of them at the bound of the last one. Goals
+// are numbered 1, 2, ... in the order a run reaches them, so a GOAL
+// in a loop is a separate goal on every iteration.
+//
+// Built with -DGOAL_ONLY=n, the n-th goal reached is asserted and the
+// run ends there; the goals before it are assumed, since they have
+// runs of their own. Adding -DGOAL_REACH turns the n-th goal into
+// assert(0), which fails iff the goal can be reached within the
+// bound (deepen.sh uses it to tell a goal that holds from one that
+// the bound is too short for). Without GOAL_ONLY every GOAL is a
+// plain assert.
+//
+// The native backend prints the clock each goal was reached at, which
+// is where goals.sh gets the bounds from.
+// ---------------------------------------------------------------------
+
+int wb_goal;
+
+#ifdef GOAL_REACH
+#define GOAL_CHECK(cond) 0
+#else
+#define GOAL_CHECK(cond) (cond)
+#endif
+
+#if defined(GOAL_ONLY) && !defined(NATIVE_SIM)
+#define GOAL(cond) do { \
+    if (++wb_goal < GOAL_ONLY) { \
+      __CPROVER_assume(cond); \
+    } else { \
+      assert(GOAL_CHECK(cond)); \
+      __CPROVER_assume(0); \
+    } \
+  } while (0)
+#elif defined(NATIVE_SIM)
+// The condition is evaluated once, it may have side effects (a read of
+// the receive buffer)
+#define GOAL(cond) do { \
+    int wb_goal_ok = (cond); \
+    ++wb_goal; \
+    fprintf(stderr, "goal %d: cycle %lu%s%s\n", wb_goal, native_cycles(), \
+            wb_goal_ok ? "" : ", failed: ", wb_goal_ok ? "" : #cond); \
+    assert(wb_goal_ok); \
+  } while (0)
+#else
+#define GOAL(cond) do { ++wb_goal; assert(cond); } while (0)
+#endif
+
+#ifdef WB_THREADED
+
+// ---------------------------------------------------------------------
+// Channels to communicate between threads
+//
+// A channel is a single-producer single-consumer ring of CHAN_DEPTH
+// messages. Only the sender moves tail and only the receiver moves
+// head, so there is no lock: the sender fills in a slot before it
+// publishes the new tail, and the receiver is done with a slot before
+// it publishes the new head. Send blocks while the ring is full,
+// receive while it is empty.
+//
+// Under the model checker a blocked thread is an assumption in an
+// atomic section. Natively (NATIVE_SIM, with pthreads) it spins on
+// the other side's index, which is loaded with acquire and stored
+// with release ordering.
+// ---------------------------------------------------------------------
+
+#ifndef CHAN_DEPTH
+#define CHAN_DEPTH 4    // a power of two
+#endif
+
+#ifdef NATIVE_SIM
+#include <sched.h>
+#define chan_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define chan_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define chan_wait(cond) do { while (!(cond)) sched_yield(); } while (0)
+#else
+#define chan_load(p) (*(p))
+#define chan_store(p, v) (*(p) = (v))
+#define chan_wait(cond) do { \
+    __CPROVER_atomic_begin(); \
+    __CPROVER_assume(cond); \
+    __CPROVER_atomic_end(); \
+  } while (0)
+#endif
+
+struct chan_msg {
+  unsigned char command;
+  unsigned char address;
+  unsigned char payload;
+};
+
+typedef struct chan_s {
+  unsigned head;        // next message to receive, receiver only
+  unsigned tail;        // next free slot, sender only
+  struct chan_msg buf[CHAN_DEPTH];
+} chan_t;
+
+static inline void chan_init (chan_t *ch) {
+  __CPROVER_HIDE:;
+  ch->head = 0;
+  ch->tail = 0;
+}
+
+static inline void chan_destroy (chan_t *ch) {
+}
+
+// Send: blocks while there are CHAN_DEPTH unreceived messages.
+static inline void chan_send (chan_t *ch, unsigned char command, unsigned char address, unsigned char payload) {
+  __CPROVER_HIDE:;
+  unsigned tail = ch->tail;
+  struct chan_msg *m = &ch->buf[tail % CHAN_DEPTH];
+  chan_wait(tail - chan_load(&ch->head) < CHAN_DEPTH);
+  m->command = command;
+  m->address = address;
+  m->payload = payload;
+  chan_store(&ch->tail, tail + 1);
+}
+
+// Receive: blocks if there is no message.
+static inline void chan_recv (chan_t *ch, unsigned char *command, unsigned char *address, unsigned char *payload) {
+  __CPROVER_HIDE:;
+  unsigned head = ch->head;
+  struct chan_msg *m = &ch->buf[head % CHAN_DEPTH];
+  chan_wait(chan_load(&ch->tail) != head);
+  *command = m->command;
+  *address = m->address;
+  *payload = m->payload;
+  chan_store(&ch->head, head + 1);
+}
+
+// Probe: returns 1 iff there's a message waiting. Receiver only.
+static inline _Bool chan_probe (chan_t *ch) {
+  __CPROVER_HIDE:;
+  return chan_load(&ch->tail) != ch->head;
+}
+
+// ---------------------------------------------------------------------
+// Temporal abstraction layer
+//
+// The hardware thread runs wb_serve(), which turns the commands
+// coming from the firmware thread into bus cycles and idles when
+// there are none. Writes are posted: the firmware runs ahead of the
+// clock until the ring is full. A read waits for its value to come
+// back over hw2fw; since fw2hw is in order, it is the answer to that
+// read.
+//
+// wb_serve() returns once the firmware sends WB_CMD_STOP (wb_stop()),
+// or after max_steps commands and idle clocks, which is what bounds
+// it for the model checker; that has to cover the firmware's run.
+// ---------------------------------------------------------------------
+
+#define WB_CMD_RESET 0
+#define WB_CMD_WRITE 1
+#define WB_CMD_READ 2
+#define WB_CMD_STOP 3
+
+chan_t fw2hw;
+chan_t hw2fw;
+
+static inline void wb_serve(int max_steps) {
+  int i;
+  unsigned char cmd = 0;
+  unsigned char addr = 0;
+  unsigned char data = 0;
+
+  for (i=0; i<max_steps; i++) {
+#ifdef NATIVE_SIM
+    // Natively the clock only runs for commands, so that a run doesn't
+    // depend on how the threads get scheduled
+    chan_wait(chan_probe(&fw2hw));
+#endif
+    if (chan_probe(&fw2hw)) {
+      chan_recv(&fw2hw, &cmd, &addr, &data);
+      switch (cmd) {
+      case WB_CMD_RESET:
+        wb_reset();
+        break;
+      case WB_CMD_WRITE:
+        wb_write(UART_TR | addr, data);
+        break;
+      case WB_CMD_READ:
+        data = wb_read(UART_TR | addr);
+        chan_send(&hw2fw, WB_CMD_READ, addr, data);
+        break;
+      case WB_CMD_STOP:
+        return;
+      default:
+        wb_idle();
+        break;
+      }
+    } else {
+      wb_idle();
+    }
+  }
+}
+
+// ---------------------------------------------------------------------
+// Linux-style inb, outb
+//
+// These execute in the firmware thread and reach wb_read/wb_write
+// in the hardware thread through the fw2hw channel.
+// ---------------------------------------------------------------------
+
+static inline unsigned char inb (unsigned long port) {
+  unsigned char cmd, addr, data;
+  chan_send(&fw2hw, WB_CMD_READ, port & 0xff, 0);
+  chan_recv(&hw2fw, &cmd, &addr, &data);
+  return data;
+}
+
+static inline void reset (void) {
+  chan_send(&fw2hw, WB_CMD_RESET, 0, 0);
+}
+
+static inline void outb (u8 value, unsigned long port) {
+  chan_send(&fw2hw, WB_CMD_WRITE, port & 0xff, value);
+}
+
+// Lets wb_serve() return
+static inline void wb_stop (void) {
+  chan_send(&fw2hw, WB_CMD_STOP, 0, 0);
+}
+
+#else
+
+// ---------------------------------------------------------------------
+// Linux-style inb, outb
+//
+// Right now, these call wb_read and wb_write directly.
+// ---------------------------------------------------------------------
+
+static inline unsigned char inb (unsigned long port) {
+  return wb_read(port);
+}
+
+static inline void outb (u8 value, unsigned long port) {
+  wb_write(port, value);
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// Batched register access
+//
+// A configuration sequence written as a table goes through one loop
+// in outb_regs() instead of one call site per register, which keeps
+// the harness program small for the model checker.
+// ---------------------------------------------------------------------
+
+struct uart_reg {
+  unsigned long port;
+  u8 value;
+};
+
+static inline void outb_regs (const struct uart_reg *regs, int n) {
+  int i;
+  for (i=0; i<n; i++)
+    outb(regs[i].value, regs[i].port);
+}
+
+#endif